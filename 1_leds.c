@@ -1,58 +1,257 @@
+// Compilar com: gcc 1_leds.c -o leds -pthread
+#define _GNU_SOURCE // Necessário para sched_yield, clock_nanosleep e CLOCK_THREAD_CPUTIME_ID
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <fcntl.h>
-#include <sys/mman.h>
+#include <signal.h>
+#include <sched.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include "hardware.h" // Mapeamento dos periféricos e offsets (LEDR_OFFSET, SW_OFFSET)
 
-// Endereço base para os periféricos de uso geral na DE1-SoC
-#define HW_REGS_BASE 0xFF200000
-// Tamanho da janela de memória a ser mapeada
-#define HW_REGS_SPAN 0x00010000
+// Registradores do PIO das chaves além do de dados
+#define SW_INTERRUPTMASK 2  // Registrador de máscara de interrupção do PIO (base + 0x8)
+#define SW_EDGECAPTURE   3  // Registrador de edge-capture do PIO (base + 0xC)
+#define SW_MASK      0x3FF  // 10 chaves
 
-// Offsets dos periféricos a partir do endereço base
-#define LEDR_OFFSET  0x0000 // Offset para os LEDs vermelhos
-#define SW_OFFSET    0x0040 // Offset para as chaves (switches)
+// Parâmetros da estratégia híbrida
+#define HYBRID_SPIN_NS      2000000 // Após uma mudança, gira com sched_yield por 2 ms
+#define HYBRID_MIN_SLEEP_US 50      // Depois dorme 50 us, dobrando a cada amostra sem mudança...
+#define HYBRID_MAX_SLEEP_US 5000    // ...até no máximo 5 ms (latência máxima quando ocioso)
+#define SLEEP_PERIOD_US     100000  // Estratégia original: uma amostra a cada 100 ms
+
+// Benchmark simulado
+#define BENCH_DURATION_NS   3000000000LL // 3 s por estratégia
+#define BENCH_MIN_GAP_US    5000         // Intervalo entre mudanças das chaves simuladas
+#define BENCH_MAX_GAP_US    50000
 
 // Ponteiros globais para os periféricos. 'volatile' é crucial para
 // garantir que o compilador não otimize o acesso à memória,
 // forçando uma leitura/escrita real no hardware a cada vez.
-volatile void *virtual_base = NULL;
 volatile unsigned int *led_ptr = NULL;
 volatile unsigned int *switch_ptr = NULL;
-int fd = -1; // Descritor de arquivo para /dev/mem
+
+// =================================================================================
+// --- ESTRATÉGIAS DE ESPELHAMENTO CHAVES -> LEDS ---
+// =================================================================================
+typedef enum {
+    MIRROR_SLEEP,   // Amostra a cada 100 ms (comportamento original)
+    MIRROR_YIELD,   // Polling contínuo cedendo a CPU com sched_yield
+    MIRROR_HYBRID,  // Polling intenso após mudanças, com backoff exponencial quando ocioso
+    MIRROR_EDGE,    // Dorme até a interrupção das chaves (UIO), quando disponível
+    MIRROR_COUNT
+} MirrorStrategy;
+
+const char *strategy_names[MIRROR_COUNT] = { "sleep", "yield", "hybrid", "edge" };
+
+typedef struct {
+    volatile unsigned int *sw;      // Registrador das chaves (início do PIO)
+    volatile unsigned int *led;     // Registrador dos LEDs
+    int irq_fd;                     // UIO das chaves ou pipe simulado (-1 = indisponível)
+    int irq_is_uio;                 // 1 = reabilitar a interrupção após cada disparo
+    const int64_t *change_ns;       // Simulação: instante de cada valor das chaves. Os valores
+                                    // são sequenciais, então a primeira mudança ainda não
+                                    // espelhada é change_ns[valor anterior + 1].
+    volatile sig_atomic_t *stop;    // O laço termina quando *stop != 0
+} MirrorTarget;
+
+typedef struct {
+    long changes;                   // Mudanças espelhadas nos LEDs
+    long samples;                   // Leituras das chaves
+    double latency_sum_ns;
+    double latency_max_ns;
+    double cpu_ns;                  // Tempo de CPU da thread do laço
+    double wall_ns;
+} MirrorStats;
+
+volatile sig_atomic_t stop_requested = 0; // Escrito pelo handler de SIGINT
+
+int64_t now_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void handle_sigint(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
 
 /**
- * @brief Inicializa o mapeamento da memória para acessar os periféricos.
- * @return 0 em caso de sucesso, -1 em caso de falha.
+ * @brief Espelha as chaves nos LEDs até *target->stop, com a estratégia escolhida.
+ *
+ * A latência de cada mudança é medida de forma exata na simulação (change_ns).
+ * No hardware o instante real da mudança não é conhecido, então é usado o
+ * limite superior: o tempo desde a amostra anterior.
  */
-int init_peripherals() {
-    // Abrir o dispositivo de memória do kernel
-    fd = open("/dev/mem", O_RDWR | O_SYNC);
-    if (fd == -1) {
-        perror("Erro ao abrir /dev/mem");
-        return -1;
+void mirror_loop(MirrorStrategy strategy, const MirrorTarget *target, MirrorStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    int64_t wall_start = now_ns(CLOCK_MONOTONIC);
+    int64_t cpu_start = now_ns(CLOCK_THREAD_CPUTIME_ID);
+
+    unsigned int current = *target->sw & SW_MASK;
+    *target->led = current;
+    int64_t last_sample = wall_start;
+    int64_t last_change = wall_start;
+    int backoff_us = HYBRID_MIN_SLEEP_US;
+
+    while (!*target->stop) {
+        // 1. Espera conforme a estratégia
+        switch (strategy) {
+            case MIRROR_SLEEP:
+                usleep(SLEEP_PERIOD_US);
+                break;
+            case MIRROR_YIELD:
+                sched_yield();
+                break;
+            case MIRROR_HYBRID:
+                if (last_sample - last_change < HYBRID_SPIN_NS) {
+                    sched_yield();
+                } else {
+                    usleep(backoff_us);
+                    if (backoff_us < HYBRID_MAX_SLEEP_US) backoff_us *= 2;
+                    if (backoff_us > HYBRID_MAX_SLEEP_US) backoff_us = HYBRID_MAX_SLEEP_US;
+                }
+                break;
+            case MIRROR_EDGE: {
+                // Timeout curto apenas para poder verificar *stop
+                struct pollfd pfd = { .fd = target->irq_fd, .events = POLLIN };
+                if (poll(&pfd, 1, 100) > 0) {
+                    uint32_t count;
+                    if (read(target->irq_fd, &count, sizeof(count)) > 0 && target->irq_is_uio) {
+                        target->sw[SW_EDGECAPTURE] = SW_MASK; // Limpa as bordas
+                        uint32_t enable = 1;
+                        if (write(target->irq_fd, &enable, sizeof(enable)) != sizeof(enable)) return;
+                    }
+                }
+                break;
+            }
+            default:
+                return;
+        }
+
+        // 2. Amostra as chaves e escreve nos LEDs apenas se mudaram
+        int64_t previous_sample = last_sample;
+        unsigned int value = *target->sw & SW_MASK;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        last_sample = now_ns(CLOCK_MONOTONIC);
+        stats->samples++;
+        if (value == current) continue;
+
+        *target->led = value;
+        last_change = last_sample;
+        backoff_us = HYBRID_MIN_SLEEP_US;
+
+        int64_t changed_at = target->change_ns ? target->change_ns[(current + 1) & SW_MASK] : previous_sample;
+        double latency = (double)(now_ns(CLOCK_MONOTONIC) - changed_at);
+        current = value;
+        stats->changes++;
+        stats->latency_sum_ns += latency;
+        if (latency > stats->latency_max_ns) stats->latency_max_ns = latency;
     }
 
-    // Mapear a região física dos periféricos para a memória virtual do programa
-    virtual_base = mmap(
-        NULL,                 // Deixar o kernel escolher o endereço virtual
-        HW_REGS_SPAN,         // Tamanho da região a ser mapeada
-        PROT_READ | PROT_WRITE, // Queremos ler e escrever na memória
-        MAP_SHARED,           // Compartilhar as alterações com outros processos
-        fd,                   // Descritor do arquivo /dev/mem
-        HW_REGS_BASE          // Endereço físico base a ser mapeado
-    );
-
-    if (virtual_base == MAP_FAILED) {
-        perror("Erro no mmap");
-        close(fd);
-        return -1;
+    stats->wall_ns = (double)(now_ns(CLOCK_MONOTONIC) - wall_start);
+    stats->cpu_ns = (double)(now_ns(CLOCK_THREAD_CPUTIME_ID) - cpu_start);
+}
+
+void print_stats_header() {
+    printf("%-8s %10s %10s %14s %14s %8s\n", "modo", "amostras", "mudancas", "lat. media(us)", "lat. max(us)", "CPU(%)");
+}
+
+void print_stats(MirrorStrategy strategy, const MirrorStats *stats) {
+    double mean = stats->changes ? stats->latency_sum_ns / stats->changes : 0.0;
+    printf("%-8s %10ld %10ld %14.1f %14.1f %8.1f\n", strategy_names[strategy], stats->samples, stats->changes,
+           mean / 1000.0, stats->latency_max_ns / 1000.0, 100.0 * stats->cpu_ns / stats->wall_ns);
+}
+
+// =================================================================================
+// --- BENCHMARK COM CHAVES SIMULADAS ---
+// =================================================================================
+// Uma thread altera as "chaves" (memória comum) em intervalos aleatórios e
+// anota o instante de cada valor; o laço de espelhamento mede a latência real.
+typedef struct {
+    unsigned int sw_regs[4];        // Registradores simulados do PIO das chaves
+    unsigned int led;
+    int64_t change_ns[SW_MASK + 1];
+    int pipe_fds[2];                // "Interrupção" simulada para a estratégia edge
+    volatile int stop;
+} SimBoard;
+
+void *switch_generator(void *arg) {
+    SimBoard *board = (SimBoard *)arg;
+    unsigned int seq = 0;
+    unsigned int seed = 1234;
+    while (!board->stop) {
+        struct timespec gap;
+        gap.tv_sec = 0;
+        gap.tv_nsec = (BENCH_MIN_GAP_US + rand_r(&seed) % (BENCH_MAX_GAP_US - BENCH_MIN_GAP_US)) * 1000L;
+        clock_nanosleep(CLOCK_MONOTONIC, 0, &gap, NULL);
+
+        seq = (seq + 1) & SW_MASK;
+        board->change_ns[seq] = now_ns(CLOCK_MONOTONIC);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        ((volatile unsigned int *)board->sw_regs)[0] = seq;
+        uint32_t irq = 1;
+        if (write(board->pipe_fds[1], &irq, sizeof(irq)) != sizeof(irq)) break;
     }
+    return NULL;
+}
 
-    // Calcula os endereços virtuais específicos para os LEDs e as chaves
-    // a partir do ponteiro base mapeado.
-    led_ptr = (volatile unsigned int *)(virtual_base + LEDR_OFFSET);
-    switch_ptr = (volatile unsigned int *)(virtual_base + SW_OFFSET);
+void *stop_after_duration(void *arg) {
+    struct timespec duration = { BENCH_DURATION_NS / 1000000000LL, BENCH_DURATION_NS % 1000000000LL };
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &duration, NULL);
+    *(volatile sig_atomic_t *)arg = 1;
+    return NULL;
+}
+
+void run_benchmark() {
+    printf("Comparando estrategias com chaves simuladas (%d s cada, mudancas a cada %d-%d us)\n",
+           (int)(BENCH_DURATION_NS / 1000000000LL), BENCH_MIN_GAP_US, BENCH_MAX_GAP_US);
+    print_stats_header();
+
+    for (int strategy = 0; strategy < MIRROR_COUNT; strategy++) {
+        static SimBoard board;
+        memset(&board, 0, sizeof(board));
+        if (pipe(board.pipe_fds) != 0) { perror("pipe"); return; }
+
+        volatile sig_atomic_t loop_stop = 0;
+        MirrorTarget target = {
+            .sw = board.sw_regs, .led = &board.led,
+            .irq_fd = board.pipe_fds[0], .irq_is_uio = 0,
+            .change_ns = board.change_ns, .stop = &loop_stop
+        };
+
+        pthread_t generator, timer;
+        pthread_create(&generator, NULL, switch_generator, &board);
+        pthread_create(&timer, NULL, stop_after_duration, (void *)&loop_stop);
+
+        MirrorStats stats;
+        mirror_loop((MirrorStrategy)strategy, &target, &stats);
+
+        pthread_join(timer, NULL);
+        board.stop = 1;
+        pthread_join(generator, NULL);
+        close(board.pipe_fds[0]);
+        close(board.pipe_fds[1]);
+        print_stats((MirrorStrategy)strategy, &stats);
+    }
+}
+
+/**
+ * @brief Inicializa o mapeamento da memória para acessar os periféricos.
+ * @return 0 em caso de sucesso, -1 em caso de falha.
+ */
+int init_peripherals() {
+    if (hw_init() != 0) return -1;
+
+    // O laço de espelhamento recebe os registradores como ponteiros, para
+    // funcionar igual com a placa simulada do benchmark
+    led_ptr = hw_reg(LEDR_OFFSET);
+    switch_ptr = hw_reg(SW_OFFSET);
 
     return 0;
 }
@@ -61,45 +260,87 @@ int init_peripherals() {
  * @brief Libera os recursos de memória mapeada e fecha o arquivo.
  */
 void cleanup_peripherals() {
-    if (virtual_base != NULL) {
-        munmap((void *)virtual_base, HW_REGS_SPAN);
+    hw_close();
+}
+
+/**
+ * @brief Abre a interrupção das chaves via UIO (variável SW_UIO_DEV, ex: /dev/uio1).
+ * @return Descritor do UIO, ou -1 se não houver interrupção disponível.
+ */
+int open_switch_irq() {
+    const char *uio_dev = getenv("SW_UIO_DEV");
+    if (uio_dev == NULL) return -1;
+    int irq_fd = open(uio_dev, O_RDWR);
+    if (irq_fd == -1) {
+        perror("Erro ao abrir SW_UIO_DEV");
+        return -1;
     }
-    if (fd != -1) {
-        close(fd);
+    switch_ptr[SW_EDGECAPTURE] = SW_MASK;   // Descarta bordas antigas
+    switch_ptr[SW_INTERRUPTMASK] = SW_MASK; // Interrompe em qualquer chave
+    uint32_t enable = 1;
+    if (write(irq_fd, &enable, sizeof(enable)) != sizeof(enable)) {
+        close(irq_fd);
+        return -1;
     }
+    return irq_fd;
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+    // Uso: ./leds [sleep|yield|hybrid|edge]   ou   ./leds --bench
+    MirrorStrategy strategy = MIRROR_HYBRID;
+    if (argc > 1) {
+        if (strcmp(argv[1], "--bench") == 0) {
+            run_benchmark();
+            return 0;
+        }
+        for (strategy = 0; strategy < MIRROR_COUNT; strategy++) {
+            if (strcmp(argv[1], strategy_names[strategy]) == 0) break;
+        }
+        if (strategy == MIRROR_COUNT) {
+            fprintf(stderr, "Uso: %s [sleep|yield|hybrid|edge|--bench]\n", argv[0]);
+            return 1;
+        }
+    }
+
     // Inicializa o acesso ao hardware
     if (init_peripherals() != 0) {
         fprintf(stderr, "Falha ao inicializar periféricos.\n");
         return 1;
     }
 
-    printf("Programa iniciado.\n");
+    int irq_fd = -1;
+    if (strategy == MIRROR_EDGE) {
+        irq_fd = open_switch_irq();
+        if (irq_fd == -1) {
+            printf("Interrupcao das chaves indisponivel (defina SW_UIO_DEV). Usando 'hybrid'.\n");
+            strategy = MIRROR_HYBRID;
+        }
+    }
+
+    printf("Programa iniciado (modo %s).\n", strategy_names[strategy]);
     printf("Movimente as chaves (SW0-SW9) e veja os LEDs (LEDR0-LEDR9) corresponderem.\n");
-    printf("Pressione CTRL+C para sair.\n");
+    printf("Pressione CTRL+C para sair e ver a latencia e o uso de CPU.\n");
 
-    // Loop principal
-    while (1) {
-        // 1. Ler o valor atual do registrador das chaves.
-        // O registrador de 32 bits contém o estado das 10 chaves nos 10 bits menos significativos.
-        unsigned int switch_value = *switch_ptr;
+    // CTRL+C apenas sinaliza o fim do laço, para que as medidas sejam exibidas
+    signal(SIGINT, handle_sigint);
 
-        // 2. Escrever o valor lido diretamente no registrador dos LEDs.
-        // O hardware da placa se encarrega de acender os LEDs correspondentes.
-        *led_ptr = switch_value;
+    MirrorTarget target = {
+        .sw = switch_ptr, .led = led_ptr,
+        .irq_fd = irq_fd, .irq_is_uio = 1,
+        .change_ns = NULL, .stop = &stop_requested
+    };
+    MirrorStats stats;
+    mirror_loop(strategy, &target, &stats);
 
-        // 3. Pequena pausa para ser um bom "cidadão" no sistema operacional,
-        // evitando o uso de 100% da CPU. 100ms é suficiente.
-        usleep(100000); 
-    }
-
-    // A cleanup_peripherals() não é chamada aqui porque o loop é infinito.
-    // Ela seria útil se o programa tivesse uma condição de saída normal.
-    // Pressionar CTRL+C termina o programa abruptamente.
-    // Para um código mais robusto, poderíamos capturar o sinal (ex: SIGINT),
-    // mas para este exercício simples, não é necessário.
+    // No hardware a latência é o limite superior (intervalo entre amostras)
+    printf("\n");
+    print_stats_header();
+    print_stats(strategy, &stats);
 
+    if (irq_fd != -1) {
+        switch_ptr[SW_INTERRUPTMASK] = 0;
+        close(irq_fd);
+    }
+    cleanup_peripherals();
     return 0;
-}
\ No newline at end of file
+}
@@ -2,92 +2,25 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
-#include <fcntl.h>
-#include <sys/mman.h>
+#include "hardware.h"    // Mapeamento dos periféricos e offsets (SW_OFFSET, ...)
+#include "hex_display.h" // Displays com registradores-sombra (sem cintilação)
 
-// Endereços e Offsets dos Periféricos
-#define HW_REGS_BASE 0xFF200000
-#define HW_REGS_SPAN 0x00010000
-#define SW_OFFSET    0x0040 // Chaves (Switches)
-#define KEY_OFFSET   0x0050 // Botões (Push-buttons)
-#define HEX3_0_OFFSET 0x0020 // Displays HEX0, 1, 2, 3
-#define HEX5_4_OFFSET 0x0030 // Displays HEX4, 5
-
-// Tabela de conversão para 7 segmentos (0-9, A-F)
-const unsigned char hex_seg_digits[16] = {
-    0x3F, // 0
-    0x06, // 1
-    0x5B, // 2
-    0x4F, // 3
-    0x66, // 4
-    0x6D, // 5
-    0x7D, // 6
-    0x07, // 7
-    0x7F, // 8
-    0x6F, // 9
-    0x77, // A
-    0x7C, // b (minúsculo para diferenciar de 8)
-    0x39, // C
-    0x5E, // d (minúsculo para diferenciar de 0)
-    0x79, // E
-    0x71  // F
-};
-
-// Ponteiros globais para os periféricos
-volatile void *virtual_base = NULL;
-volatile unsigned int *switch_ptr = NULL;
-volatile unsigned int *key_ptr = NULL;
-volatile unsigned int *hex3_0_ptr = NULL;
-volatile unsigned int *hex5_4_ptr = NULL;
-int fd = -1;
-
-/**
- * @brief Inicializa o acesso aos periféricos via mapeamento de memória.
- * @return 0 em sucesso, -1 em falha.
- */
-int init_peripherals() {
-    fd = open("/dev/mem", O_RDWR | O_SYNC);
-    if (fd == -1) {
-        perror("Erro ao abrir /dev/mem");
-        return -1;
-    }
-
-    virtual_base = mmap(NULL, HW_REGS_SPAN, PROT_READ | PROT_WRITE, MAP_SHARED, fd, HW_REGS_BASE);
-    if (virtual_base == MAP_FAILED) {
-        perror("Erro no mmap");
-        close(fd);
-        return -1;
-    }
-
-    // Calcula os endereços virtuais para cada periférico
-    switch_ptr = (volatile unsigned int *)(virtual_base + SW_OFFSET);
-    key_ptr = (volatile unsigned int *)(virtual_base + KEY_OFFSET);
-    hex3_0_ptr = (volatile unsigned int *)(virtual_base + HEX3_0_OFFSET);
-    hex5_4_ptr = (volatile unsigned int *)(virtual_base + HEX5_4_OFFSET);
-
-    return 0;
-}
+HexDisplay hex; // Displays HEX5-HEX0 (ver hex_display.h)
 
 /**
  * @brief Libera os recursos ao finalizar o programa.
  */
 void cleanup_peripherals() {
-    if (hex3_0_ptr) *hex3_0_ptr = 0;
-    if (hex5_4_ptr) *hex5_4_ptr = 0;
-    
-    if (virtual_base != NULL) {
-        munmap((void *)virtual_base, HW_REGS_SPAN);
-    }
-    if (fd != -1) {
-        close(fd);
-    }
+    hex_clear(&hex);
+    hw_close();
 }
 
 int main() {
-    if (init_peripherals() != 0) {
+    if (hw_init() != 0) {
         fprintf(stderr, "Falha ao inicializar periféricos.\n");
         return 1;
     }
+    hex_init(&hex, hw_reg(HEX3_0_OFFSET), hw_reg(HEX5_4_OFFSET));
     
     atexit(cleanup_peripherals);
 
@@ -104,13 +37,13 @@ int main() {
         // --- LEITURA DAS ENTRADAS ---
         
         // Lê as chaves e mascara para obter apenas os 4 bits menos significativos (0 a F)
-        unsigned int digit_to_display = *switch_ptr & 0x0F;
+        unsigned int digit_to_display = hw_read(SW_OFFSET) & 0x0F;
         
         // Converte o dígito lido para o código de 7 segmentos
-        unsigned char hex_code = hex_seg_digits[digit_to_display];
+        unsigned char hex_code = hex_digit_codes[digit_to_display];
 
         // Lê o estado atual dos botões
-        unsigned int current_key_state = *key_ptr;
+        unsigned int current_key_state = hw_read(KEY_OFFSET);
         
         // --- LÓGICA DE CONTROLE ---
 
@@ -126,19 +59,13 @@ int main() {
 
         // --- ATUALIZAÇÃO DA SAÍDA (DISPLAYS) ---
         
-        // 1. Apaga todos os displays para garantir que apenas um esteja aceso
-        *hex3_0_ptr = 0;
-        *hex5_4_ptr = 0;
+        // 1. Monta os 6 displays com apenas o da posição atual aceso
+        uint8_t codes[HEX_DIGITS] = {0};
+        codes[position] = hex_code;
 
-        // 2. Acende o display na posição correta
-        switch (position) {
-            case 0: *hex3_0_ptr = hex_code; break;
-            case 1: *hex3_0_ptr = hex_code << 8; break;
-            case 2: *hex3_0_ptr = hex_code << 16; break;
-            case 3: *hex3_0_ptr = hex_code << 24; break;
-            case 4: *hex5_4_ptr = hex_code; break;
-            case 5: *hex5_4_ptr = hex_code << 8; break;
-        }
+        // 2. Uma escrita por registrador, só se mudou: o display não chega a
+        // ficar apagado entre as atualizações (antes ele piscava)
+        hex_show_codes(&hex, codes);
 
         // --- ATUALIZAÇÃO DO ESTADO PARA O PRÓXIMO FRAME ---
 
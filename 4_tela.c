@@ -5,11 +5,12 @@
 #include <ctype.h>
 #include <stdint.h>
 #include <unistd.h>
-#include <fcntl.h>
-#include <sys/mman.h>
+#include <time.h>
+#include "hardware.h"
+#include "compositor.h"
+#include "framebuffer.h"
 
 // --- Configurações da VGA (do seu código base) ---
-#define FRAME_BASE      0xC8000000
 #define LWIDTH          512      // Largura completa da linha na memória (stride)
 #define VISIBLE_WIDTH   320      // Largura visível
 #define VISIBLE_HEIGHT  240      // Altura visível
@@ -34,9 +35,11 @@
 #define TEAL    0x0410
 
 // --- Variáveis Globais ---
-int mem_fd; 
 volatile uint16_t (*tela)[LWIDTH]; 
 uint16_t current_color = BLACK; // Cor inicial é preta
+Framebuffer fb;                 // Framebuffer direto ou com buffer em cache (ver framebuffer.h)
+CompSurface surface;            // Superfície do compositor (ver compositor.h)
+int compositing = 0;            // 1 = desenha na superfície em vez da VGA
 
 // --- Protótipos de Funções ---
 void fill_screen();
@@ -47,35 +50,40 @@ int set_color(const char *color_name);
 // =================================================================================
 void cleanup_vga() {
     fill_screen(BLACK); // Limpa a tela ao sair
-    if (tela != NULL) {
-        munmap((void*)tela, LWIDTH * VISIBLE_HEIGHT * PIXEL_SIZE);
-    }
-    if (mem_fd != -1) {
-        close(mem_fd);
+    if (compositing) {
+        comp_surface_close(&surface);
+    } else {
+        fb_close(&fb);
+        hw_close();
     }
     printf("\nRecursos da VGA liberados. Saindo.\n");
 }
 
 int init_vga() {
-    mem_fd = open("/dev/mem", O_RDWR | O_SYNC);
-    if (mem_fd == -1) {
-        perror("Erro ao abrir /dev/mem");
-        return -1;
+    // Com VGA_COMPOSITOR definido, a tela é uma superfície do compositor
+    int comp_x, comp_y, comp_z;
+    if (comp_env_geometry(&comp_x, &comp_y, &comp_z)) {
+        if (comp_surface_open(&surface, comp_x, comp_y, VISIBLE_WIDTH, VISIBLE_HEIGHT, comp_z) != 0) {
+            fprintf(stderr, "Erro ao abrir superficie do compositor\n");
+            return -1;
+        }
+        tela = (volatile uint16_t (*)[LWIDTH]) surface.pixels;
+        compositing = 1;
+        atexit(cleanup_vga);
+        return 0;
     }
 
-    void *framebuffer_map = mmap(
-        NULL, LWIDTH * VISIBLE_HEIGHT * PIXEL_SIZE,
-        PROT_READ | PROT_WRITE, MAP_SHARED,
-        mem_fd, FRAME_BASE
-    );
+    if (hw_init() != 0) {
+        return -1;
+    }
 
-    if (framebuffer_map == MAP_FAILED) {
-        perror("Erro ao mapear o framebuffer da VGA");
-        close(mem_fd);
+    // VGA_FB_MODE=staged desenha num buffer em cache, copiado a cada fill_screen
+    if (fb_open(&fb, hw_framebuffer(), fb_env_staged()) != 0) {
+        hw_close();
         return -1;
     }
     
-    tela = (volatile uint16_t (*)[LWIDTH]) framebuffer_map;
+    tela = fb.pixels;
     atexit(cleanup_vga);
     return 0;
 }
@@ -110,6 +118,8 @@ void fill_screen() {
             tela[y][x] = color;
         }
     }
+    if (compositing) comp_damage(&surface, 0, 0, VISIBLE_WIDTH, VISIBLE_HEIGHT);
+    else fb_present(&fb); // No modo direto não faz nada
 }
 
 /**
@@ -145,7 +155,98 @@ int set_color(const char *color_name) {
     return 1; // Sucesso
 }
 
-int main() {
+// =================================================================================
+// --- BENCHMARK: ESCRITA DIRETA x BUFFER EM CACHE ---
+// =================================================================================
+// Executado com "./4_tela --bench-fb". Usa a VGA se /dev/mem estiver disponível,
+// senão um framebuffer em memória (aí a diferença entre os modos é pequena).
+#define BENCH_FILLS  200
+#define BENCH_FRAMES 200
+
+double elapsed_seconds(struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Quadro "completo": cada pixel com um valor diferente, como num jogo
+void draw_test_frame(int frame) {
+    for (int y = 0; y < VISIBLE_HEIGHT; y++) {
+        for (int x = 0; x < VISIBLE_WIDTH; x++) {
+            tela[y][x] = (uint16_t)((x * 7 + y * 13 + frame * 31) ^ (x << 5));
+        }
+    }
+    fb_present(&fb);
+}
+
+// Mede fill_screen e quadros completos num modo; retorna MB/s dos dois (-1 se fb_open falhou)
+int bench_mode(volatile void *device, int staged, double *fill_mbs, double *frame_mbs) {
+    struct timespec start;
+    double bytes = (double)VISIBLE_WIDTH * VISIBLE_HEIGHT * PIXEL_SIZE;
+    uint16_t colors[] = { RED, GREEN, BLUE, WHITE };
+
+    if (fb_open(&fb, device, staged) != 0) return -1;
+    tela = fb.pixels;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_FILLS; i++) {
+        current_color = colors[i % 4];
+        fill_screen();
+    }
+    *fill_mbs = bytes * BENCH_FILLS / elapsed_seconds(&start) / 1e6;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_FRAMES; i++) draw_test_frame(i);
+    *frame_mbs = bytes * BENCH_FRAMES / elapsed_seconds(&start) / 1e6;
+    return 0;
+}
+
+int run_fb_benchmark() {
+    static uint16_t reference[VISIBLE_HEIGHT][VISIBLE_WIDTH];
+    double direct_fill, direct_frame, staged_fill, staged_frame;
+
+    volatile void *device = hw_init() == 0 ? hw_framebuffer() : NULL;
+    printf("Framebuffer: %s\n", device != NULL ? HW_BACKEND_NAME : "em memoria (sem a placa)");
+
+    // Modo direto; a última imagem fica como referência
+    if (bench_mode(device, 0, &direct_fill, &direct_frame) != 0) {
+        fprintf(stderr, "Erro: nao foi possivel abrir o framebuffer (modo direto).\n");
+        hw_close();
+        return -1;
+    }
+    for (int y = 0; y < VISIBLE_HEIGHT; y++) {
+        for (int x = 0; x < VISIBLE_WIDTH; x++) reference[y][x] = fb.device[y][x];
+    }
+    fb_close(&fb);
+
+    // Modo com buffer em cache: a tela precisa terminar idêntica
+    if (bench_mode(device, 1, &staged_fill, &staged_frame) != 0) {
+        fprintf(stderr, "Erro: nao foi possivel alocar o buffer em cache (modo staged).\n");
+        hw_close();
+        return -1;
+    }
+    long mismatches = fb_verify(&fb);
+    for (int y = 0; y < VISIBLE_HEIGHT; y++) {
+        for (int x = 0; x < VISIBLE_WIDTH; x++) {
+            if (fb.device[y][x] != reference[y][x]) mismatches++;
+        }
+    }
+    fb_close(&fb);
+    hw_close();
+
+    printf("%-10s %14s %16s\n", "Modo", "fill (MB/s)", "quadros (MB/s)");
+    printf("%-10s %14.1f %16.1f\n", "direto", direct_fill, direct_frame);
+    printf("%-10s %14.1f %16.1f\n", "staged", staged_fill, staged_frame);
+    printf("Ganho: fill %.2fx, quadros %.2fx\n", staged_fill / direct_fill, staged_frame / direct_frame);
+    printf("Verificacao da imagem: %s (%ld pixels diferentes)\n", mismatches == 0 ? "OK" : "FALHOU", mismatches);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--bench-fb") == 0) {
+        return run_fb_benchmark() == 0 ? 0 : 1;
+    }
+
     if (init_vga() != 0) {
         return 1;
     }
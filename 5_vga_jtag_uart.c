@@ -4,11 +4,9 @@
 #include <ctype.h>
 #include <stdint.h>
 #include <unistd.h>
-#include <fcntl.h>
-#include <sys/mman.h>
+#include "hardware.h"
 
 // --- Configurações da VGA ---
-#define FRAME_BASE      0xC8000000
 #define LWIDTH          512      // Largura completa da linha na memória (stride)
 #define VISIBLE_WIDTH   320      // Largura visível
 #define VISIBLE_HEIGHT  240      // Altura visível
@@ -33,7 +31,6 @@
 #define TEAL    0x0410
 
 // --- Variáveis Globais para acesso ao Hardware ---
-int mem_fd; 
 volatile uint16_t (*tela)[LWIDTH]; 
 uint16_t current_color = WHITE;
 
@@ -48,38 +45,15 @@ void draw_rect(int x0, int y0, int x1, int y1);
 
 // --- Funções de Inicialização e Limpeza ---
 void cleanup_vga() {
-    if (tela != NULL) {
-        munmap((void*)tela, LWIDTH * VISIBLE_HEIGHT * PIXEL_SIZE);
-    }
-    if (mem_fd != -1) {
-        close(mem_fd);
-    }
+    hw_close();
     printf("\nRecursos da VGA liberados. Saindo.\n");
 }
 
 int init_vga() {
-    mem_fd = open("/dev/mem", O_RDWR | O_SYNC);
-    if (mem_fd == -1) {
-        perror("Erro ao abrir /dev/mem");
-        return -1;
-    }
-
-    void *framebuffer_map = mmap(
-        NULL,
-        LWIDTH * VISIBLE_HEIGHT * PIXEL_SIZE,
-        PROT_READ | PROT_WRITE,
-        MAP_SHARED,
-        mem_fd,
-        FRAME_BASE
-    );
-
-    if (framebuffer_map == MAP_FAILED) {
-        perror("Erro ao mapear o framebuffer da VGA");
-        close(mem_fd);
+    if (hw_init() != 0) {
         return -1;
     }
-    
-    tela = (volatile uint16_t (*)[LWIDTH]) framebuffer_map;
+    tela = hw_framebuffer();
     atexit(cleanup_vga);
     return 0;
 }
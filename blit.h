@@ -0,0 +1,117 @@
+#ifndef BLIT_H
+#define BLIT_H
+
+#include <stdint.h>
+#include <string.h>
+
+// =================================================================================
+// --- CÓPIA DE REGIÕES (BLIT) ---
+// =================================================================================
+// Copia retângulos dentro de uma superfície em memória comum (com cache),
+// com origem e destino podendo se sobrepor: as linhas são percorridas de
+// baixo para cima quando o destino está abaixo da origem, e cada linha é um
+// memmove(). O recorte é feito uma vez, no retângulo inteiro, e não por pixel.
+// Quando o retângulo ocupa a largura toda e não se move na horizontal (rolagem
+// vertical da tela), as linhas são contíguas e a cópia vira um único memmove().
+//
+// A superfície nunca é o framebuffer O_SYNC: lá cada leitura é uma transação
+// no barramento e memmove() pode fazer acessos desalinhados, que a memória de
+// dispositivo não aceita. O resultado vai para a tela com blit_present(), que
+// só escreve (alinhado, 64 bits por vez) o retângulo de destino.
+//
+// Uso: BlitSurface s = blit_surface(buffer, stride, largura, altura);
+// blit_copy(&s, x, y, w, h, destino_x, destino_y, &r) e, se a superfície é a
+// cópia da tela, blit_present(&s, &tela[0][0], LWIDTH, &r).
+
+typedef struct {
+    uint16_t *pixels;   // Memória comum (com cache)
+    int stride;         // Pixels entre o início de duas linhas
+    int width, height;  // Área válida
+} BlitSurface;
+
+typedef struct {
+    int x, y, w, h;
+} BlitRect;
+
+static inline BlitSurface blit_surface(void *pixels, int stride, int width, int height) {
+    BlitSurface s = { (uint16_t *)pixels, stride, width, height };
+    return s;
+}
+
+/**
+ * @brief Recorta origem e destino contra a superfície, mantendo os dois alinhados.
+ * @return 1 se sobrou algo para copiar, 0 caso contrário.
+ */
+static inline int blit_clip(const BlitSurface *s, int *x, int *y, int *w, int *h, int *to_x, int *to_y) {
+    if (*x < 0)    { *w += *x;    *to_x -= *x;  *x = 0; }
+    if (*to_x < 0) { *w += *to_x; *x -= *to_x;  *to_x = 0; }
+    if (*y < 0)    { *h += *y;    *to_y -= *y;  *y = 0; }
+    if (*to_y < 0) { *h += *to_y; *y -= *to_y;  *to_y = 0; }
+    if (*x + *w > s->width)     *w = s->width - *x;
+    if (*to_x + *w > s->width)  *w = s->width - *to_x;
+    if (*y + *h > s->height)    *h = s->height - *y;
+    if (*to_y + *h > s->height) *h = s->height - *to_y;
+    return *w > 0 && *h > 0;
+}
+
+/**
+ * @brief Copia o retângulo (x, y, w, h) para (to_x, to_y) na mesma superfície.
+ * @param dest Recebe o retângulo de destino já recortado (pode ser NULL).
+ * @return Pixels copiados (0 se o recorte não deixou nada).
+ */
+static inline int blit_copy(BlitSurface *s, int x, int y, int w, int h, int to_x, int to_y, BlitRect *dest) {
+    if (!blit_clip(s, &x, &y, &w, &h, &to_x, &to_y)) return 0;
+    if (dest != NULL) *dest = (BlitRect){ to_x, to_y, w, h };
+    if (x == to_x && y == to_y) return w * h;
+
+    uint16_t *src = s->pixels + (long)y * s->stride + x;
+    uint16_t *dst = s->pixels + (long)to_y * s->stride + to_x;
+    if (x == 0 && to_x == 0 && w == s->width) {
+        // Largura toda: as linhas (com o espaço além de width) são um bloco só
+        memmove(dst, src, ((size_t)(h - 1) * s->stride + w) * sizeof(uint16_t));
+    } else if (to_y > y) {
+        // Destino abaixo: de baixo para cima, para não sobrescrever a origem
+        for (int row = h - 1; row >= 0; row--) {
+            memmove(dst + (long)row * s->stride, src + (long)row * s->stride, w * sizeof(uint16_t));
+        }
+    } else {
+        for (int row = 0; row < h; row++) {
+            memmove(dst + (long)row * s->stride, src + (long)row * s->stride, w * sizeof(uint16_t));
+        }
+    }
+    return w * h;
+}
+
+// Escreve n pixels no framebuffer: 16 bits até alinhar, depois 64 bits por vez
+static inline void blit_store_row(volatile uint16_t *dst, const uint16_t *src, int n) {
+    while (n > 0 && ((uintptr_t)dst & 7) != 0) {
+        *dst++ = *src++;
+        n--;
+    }
+    volatile uint64_t *dst64 = (volatile uint64_t *)dst;
+    for (; n >= 4; n -= 4) {
+        uint64_t word;
+        memcpy(&word, src, sizeof(word));
+        *dst64++ = word;
+        src += 4;
+    }
+    dst = (volatile uint16_t *)dst64;
+    while (n-- > 0) *dst++ = *src++;
+}
+
+// Escritas no barramento que blit_store_row(dst, ..., n) faz (o mesmo vale para indexed_store_row)
+static inline int blit_store_count(volatile const uint16_t *dst, int n) {
+    int head = (int)((8 - ((uintptr_t)dst & 7)) & 7) / 2;
+    if (head > n) head = n;
+    n -= head;
+    return head + n / 4 + n % 4;
+}
+
+// Copia o retângulo 'r' da superfície para a mesma posição no framebuffer
+static inline void blit_present(const BlitSurface *s, volatile uint16_t *device, int device_stride, const BlitRect *r) {
+    for (int row = r->y; row < r->y + r->h; row++) {
+        blit_store_row(device + (long)row * device_stride + r->x, s->pixels + (long)row * s->stride + r->x, r->w);
+    }
+}
+
+#endif
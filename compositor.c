@@ -0,0 +1,369 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include "hardware.h"
+#include "compositor.h"
+
+// =================================================================================
+// --- DEFINIÇÕES DE HARDWARE ---
+// =================================================================================
+#define PIXEL_CTRL_FRONT   0       // Escrever 1 pede a troca de buffers no próximo vsync
+#define PIXEL_CTRL_BACK    1       // Endereço do buffer de trás (entra na próxima troca)
+#define PIXEL_CTRL_STATUS  3       // Bit 0 (S) fica em 1 até a troca acontecer
+
+#define LWIDTH          COMP_LWIDTH
+#define VISIBLE_WIDTH   COMP_SCREEN_WIDTH
+#define VISIBLE_HEIGHT  COMP_SCREEN_HEIGHT
+#define PIXEL_SIZE      2
+
+#define BG_COLOR        0x0000     // Onde nenhuma superfície cobre a tela
+#define FRAME_NS        16666667   // 60 Hz (também a previsão do próximo retraço)
+#define VSYNC_MARGIN_NS 1000000    // Acorda 1 ms antes do retraço esperado
+#define VSYNC_POLL_NS   100000     // Depois disso, lê o bit S a cada 0,1 ms
+#define MAX_DAMAGE      64         // Acima disso os retângulos viram um só
+#define LIVENESS_FRAMES 60         // Verifica clientes mortos uma vez por segundo
+
+// =================================================================================
+// --- VARIÁVEIS GLOBAIS ---
+// =================================================================================
+volatile uint16_t (*tela)[LWIDTH];
+volatile unsigned int *pixel_ctrl = NULL; // NULL = vsync simulado por temporizador
+int offscreen = 0;
+CompShared *shared = NULL;
+volatile sig_atomic_t stop_requested = 0;
+
+// Estado do compositor para cada slot (visão local, fora da memória compartilhada)
+typedef struct {
+    uint16_t *pixels;   // NULL = superfície não mapeada
+    size_t size;
+    int x, y, z;        // Geometria usada no último quadro composto
+    int width, height;
+} SurfaceView;
+
+SurfaceView views[COMP_MAX_SURFACES];
+CompRect damage[MAX_DAMAGE];
+int damage_count = 0;
+uint16_t row_buffer[VISIBLE_WIDTH];
+
+// Estatísticas
+unsigned long frames = 0;
+unsigned long frames_composed = 0;
+unsigned long long pixels_written = 0;
+
+// =================================================================================
+// --- INICIALIZAÇÃO E LIMPEZA ---
+// =================================================================================
+void handle_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+int init_framebuffer() {
+    if (hw_init() == 0) {
+        tela = hw_framebuffer();
+#ifndef HW_SIM // O controlador simulado nunca sinalizaria o vsync
+        pixel_ctrl = hw_reg(PIXEL_CTRL_OFFSET);
+        // A troca usada como espera do vsync só é inofensiva com os dois
+        // buffers no nosso framebuffer. O de trás pode ter ficado em outro
+        // endereço (padrão do sistema ou outro programa): aponta para o nosso,
+        // troca uma vez (a frente passa a ser o nosso) e aponta de novo
+        pixel_ctrl[PIXEL_CTRL_BACK] = HW_FRAME_BASE;
+        pixel_ctrl[PIXEL_CTRL_FRONT] = 1;
+        while (pixel_ctrl[PIXEL_CTRL_STATUS] & 1) {}
+        pixel_ctrl[PIXEL_CTRL_BACK] = HW_FRAME_BASE;
+#endif
+        return 0;
+    }
+
+    // Sem a placa: compõe num framebuffer em memória (útil para testar clientes)
+    printf("Aviso: /dev/mem indisponivel, usando framebuffer em memoria.\n");
+    void *vga_map = calloc(LWIDTH * VISIBLE_HEIGHT, PIXEL_SIZE);
+    if (vga_map == NULL) return -1;
+    tela = (volatile uint16_t (*)[LWIDTH])vga_map;
+    offscreen = 1;
+    return 0;
+}
+
+int init_shared() {
+    shm_unlink(COMP_SHM_NAME); // Descarta o segmento de uma execução anterior
+    int fd = shm_open(COMP_SHM_NAME, O_RDWR | O_CREAT | O_EXCL, 0666);
+    if (fd == -1) {
+        perror("Erro ao criar memoria compartilhada");
+        return -1;
+    }
+    if (ftruncate(fd, sizeof(CompShared)) != 0) {
+        perror("Erro ao dimensionar memoria compartilhada");
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, sizeof(CompShared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("Erro ao mapear memoria compartilhada");
+        return -1;
+    }
+    shared = (CompShared *)map;
+    memset(shared, 0, sizeof(CompShared));
+    shared->magic = COMP_MAGIC;
+    return 0;
+}
+
+void release_view(int index) {
+    char name[32];
+    if (views[index].pixels != NULL) munmap(views[index].pixels, views[index].size);
+    views[index].pixels = NULL;
+    snprintf(name, sizeof(name), COMP_SURFACE_NAME_FMT, index);
+    shm_unlink(name);
+}
+
+void cleanup_resources() {
+    for (int i = 0; i < COMP_MAX_SURFACES; i++) release_view(i);
+    if (shared != NULL) {
+        shared->magic = 0; // Clientes que ainda tentarem abrir são recusados
+        munmap(shared, sizeof(CompShared));
+        shm_unlink(COMP_SHM_NAME);
+    }
+    if (offscreen) free((void *)tela);
+    else hw_close();
+    printf("\nCompositor encerrado: %lu quadros, %lu com dano, %llu pixels escritos.\n",
+           frames, frames_composed, pixels_written);
+}
+
+// =================================================================================
+// --- VSYNC ---
+// =================================================================================
+// No hardware, pedir uma troca com os dois buffers apontando para o mesmo
+// endereço (init_framebuffer() garante isso) não muda a imagem, mas o bit S só volta a 0 no retraço vertical.
+// Sem o controlador, um temporizador absoluto de 60 Hz faz o mesmo papel.
+//
+// Ler o bit S sem parar prenderia um dos dois núcleos do A9 o quadro inteiro,
+// tirando-o dos clientes: a partir do último retraço visto, dorme até pouco
+// antes do próximo e só então lê o bit, com pausas curtas entre as leituras.
+int64_t monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void wait_vsync() {
+    static struct timespec next = {0, 0};
+    if (pixel_ctrl != NULL) {
+        static int64_t last_retrace = 0; // 0 = fase do retraço ainda desconhecida
+        pixel_ctrl[PIXEL_CTRL_FRONT] = 1;
+        if (last_retrace != 0) {
+            // Pula os retraços que já passaram (quadro que demorou mais de 16,6 ms)
+            int64_t wake = last_retrace + FRAME_NS - VSYNC_MARGIN_NS;
+            int64_t now = monotonic_ns();
+            while (wake + VSYNC_MARGIN_NS <= now) wake += FRAME_NS;
+            struct timespec until = { (time_t)(wake / 1000000000LL), (long)(wake % 1000000000LL) };
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL);
+        }
+        const struct timespec step = { 0, VSYNC_POLL_NS };
+        while (pixel_ctrl[PIXEL_CTRL_STATUS] & 1) {
+            if (stop_requested) return;
+            nanosleep(&step, NULL);
+        }
+        last_retrace = monotonic_ns();
+        return;
+    }
+
+    if (next.tv_sec == 0) clock_gettime(CLOCK_MONOTONIC, &next);
+    next.tv_nsec += FRAME_NS;
+    if (next.tv_nsec >= 1000000000L) {
+        next.tv_nsec -= 1000000000L;
+        next.tv_sec++;
+    }
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+}
+
+// =================================================================================
+// --- DANO ---
+// =================================================================================
+// Acrescenta um retângulo (coordenadas de tela) à lista de dano do quadro
+void add_damage(int x0, int y0, int x1, int y1) {
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > VISIBLE_WIDTH) x1 = VISIBLE_WIDTH;
+    if (y1 > VISIBLE_HEIGHT) y1 = VISIBLE_HEIGHT;
+    if (x0 >= x1 || y0 >= y1) return;
+
+    // Junta com um retângulo existente que já contenha o novo
+    for (int i = 0; i < damage_count; i++) {
+        CompRect *r = &damage[i];
+        if (x0 >= r->x0 && y0 >= r->y0 && x1 <= r->x1 && y1 <= r->y1) return;
+    }
+
+    if (damage_count == MAX_DAMAGE) {
+        // Lista cheia: tudo vira o retângulo envolvente
+        for (int i = 0; i < damage_count; i++) {
+            if (damage[i].x0 < x0) x0 = damage[i].x0;
+            if (damage[i].y0 < y0) y0 = damage[i].y0;
+            if (damage[i].x1 > x1) x1 = damage[i].x1;
+            if (damage[i].y1 > y1) y1 = damage[i].y1;
+        }
+        damage_count = 0;
+    }
+    damage[damage_count].x0 = x0;
+    damage[damage_count].y0 = y0;
+    damage[damage_count].x1 = x1;
+    damage[damage_count].y1 = y1;
+    damage_count++;
+}
+
+void damage_view(SurfaceView *v) {
+    add_damage(v->x, v->y, v->x + v->width, v->y + v->height);
+}
+
+int map_view(int index) {
+    CompSlot *slot = &shared->slots[index];
+    SurfaceView *v = &views[index];
+    char name[32];
+    snprintf(name, sizeof(name), COMP_SURFACE_NAME_FMT, index);
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd == -1) return -1;
+    v->size = comp_surface_bytes(slot->height);
+    void *map = mmap(NULL, v->size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+    v->pixels = (uint16_t *)map;
+    v->width = slot->width;
+    v->height = slot->height;
+    v->x = atomic_load(&slot->x);
+    v->y = atomic_load(&slot->y);
+    v->z = atomic_load(&slot->z);
+    return 0;
+}
+
+// Lê os anéis de dano de todos os clientes e atualiza a lista do quadro
+void collect_damage(int check_liveness) {
+    for (int i = 0; i < COMP_MAX_SURFACES; i++) {
+        CompSlot *slot = &shared->slots[i];
+        SurfaceView *v = &views[i];
+        uint32_t state = atomic_load_explicit(&slot->state, memory_order_acquire);
+
+        // Cliente terminou sem fechar a superfície, ou morreu no meio do
+        // comp_surface_open() (pid 0 = ainda não gravado)
+        if ((state == COMP_SLOT_ACTIVE || state == COMP_SLOT_CLAIMED) && check_liveness) {
+            int32_t pid = atomic_load(&slot->pid);
+            if (pid > 0 && kill(pid, 0) == -1 && errno == ESRCH) state = COMP_SLOT_CLOSING;
+        }
+
+        if (state == COMP_SLOT_CLOSING) {
+            if (v->pixels != NULL) damage_view(v);
+            release_view(i);
+            atomic_store(&slot->pid, 0); // Antes do FREE: o próximo dono grava o seu
+            atomic_store_explicit(&slot->state, COMP_SLOT_FREE, memory_order_release);
+            continue;
+        }
+        if (state != COMP_SLOT_ACTIVE) continue;
+
+        if (v->pixels == NULL) {
+            if (map_view(i) != 0) continue;
+            damage_view(v);
+        }
+
+        // Mudança de posição ou de ordem: redesenha a área antiga e a nova
+        int x = atomic_load(&slot->x), y = atomic_load(&slot->y), z = atomic_load(&slot->z);
+        if (x != v->x || y != v->y || z != v->z) {
+            damage_view(v);
+            v->x = x; v->y = y; v->z = z;
+            damage_view(v);
+        }
+
+        uint32_t tail = atomic_load_explicit(&slot->tail, memory_order_relaxed);
+        uint32_t head = atomic_load_explicit(&slot->head, memory_order_acquire);
+        if (atomic_exchange_explicit(&slot->overflow, 0, memory_order_acquire)) {
+            damage_view(v);
+            tail = head; // O anel inteiro já está coberto
+        }
+        while (tail != head) {
+            CompRect r = slot->ring[tail & (COMP_RING_SIZE - 1)];
+            add_damage(v->x + r.x0, v->y + r.y0, v->x + r.x1, v->y + r.y1);
+            tail++;
+        }
+        atomic_store_explicit(&slot->tail, tail, memory_order_release);
+    }
+}
+
+// =================================================================================
+// --- COMPOSIÇÃO ---
+// =================================================================================
+// Ordena as superfícies mapeadas por z (de baixo para cima)
+int sorted_views(SurfaceView **order) {
+    int count = 0;
+    for (int i = 0; i < COMP_MAX_SURFACES; i++) {
+        if (views[i].pixels == NULL) continue;
+        int j = count++;
+        while (j > 0 && order[j - 1]->z > views[i].z) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = &views[i];
+    }
+    return count;
+}
+
+// Recompõe um retângulo: cada linha é montada em memória comum (pintor, por z)
+// e só então copiada para o framebuffer, uma escrita por pixel.
+void compose_rect(const CompRect *r, SurfaceView **order, int count) {
+    int width = r->x1 - r->x0;
+    for (int y = r->y0; y < r->y1; y++) {
+        for (int x = 0; x < width; x++) row_buffer[x] = BG_COLOR;
+
+        for (int i = 0; i < count; i++) {
+            SurfaceView *v = order[i];
+            if (y < v->y || y >= v->y + v->height) continue;
+            int x0 = r->x0 > v->x ? r->x0 : v->x;
+            int x1 = r->x1 < v->x + v->width ? r->x1 : v->x + v->width;
+            if (x0 >= x1) continue;
+            const uint16_t *src = v->pixels + (size_t)(y - v->y) * COMP_LWIDTH + (x0 - v->x);
+            memcpy(&row_buffer[x0 - r->x0], src, (x1 - x0) * sizeof(uint16_t));
+        }
+
+        for (int x = 0; x < width; x++) tela[y][r->x0 + x] = row_buffer[x];
+    }
+    pixels_written += (unsigned long long)width * (r->y1 - r->y0);
+}
+
+void compose_frame() {
+    SurfaceView *order[COMP_MAX_SURFACES];
+    int count = sorted_views(order);
+    for (int i = 0; i < damage_count; i++) compose_rect(&damage[i], order, count);
+    if (damage_count > 0) frames_composed++;
+    damage_count = 0;
+}
+
+int main() {
+    if (init_framebuffer() != 0) return 1;
+    if (init_shared() != 0) return 1;
+    atexit(cleanup_resources);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handle_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    // Começa com a tela inteira no fundo
+    add_damage(0, 0, VISIBLE_WIDTH, VISIBLE_HEIGHT);
+    compose_frame();
+
+    printf("Compositor ativo em %s (%d superficies). Ctrl+C para sair.\n", COMP_SHM_NAME, COMP_MAX_SURFACES);
+    printf("Clientes: VGA_COMPOSITOR=x,y,z ./snake (ou ./4_tela)\n");
+
+    while (!stop_requested) {
+        wait_vsync();
+        frames++;
+        collect_damage(frames % LIVENESS_FRAMES == 0);
+        compose_frame();
+    }
+    return 0;
+}
@@ -0,0 +1,188 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+// =================================================================================
+// --- COMPOSITOR: MEMÓRIA COMPARTILHADA ENTRE O COMPOSITOR E OS CLIENTES ---
+// =================================================================================
+// O processo compositor (compositor.c) é o único que escreve no framebuffer da
+// VGA. Cada programa cliente recebe uma superfície RGB565 própria em memória
+// compartilhada POSIX, com posição e ordem z, e desenha nela como desenharia
+// na tela (mesmo stride LWIDTH, então tela[y][x] continua valendo).
+//
+// Depois de desenhar, o cliente informa as regiões alteradas (dano) num anel
+// lock-free de produtor/consumidor único dentro da memória compartilhada; não
+// há chamada de sistema por quadro. O compositor, no ritmo do vsync, lê os
+// anéis e recompõe apenas as regiões danificadas.
+//
+// Uso no cliente: comp_surface_open(), desenhar em surface.pixels,
+// comp_damage() para cada região alterada e comp_surface_close() ao sair.
+// Compilar com -lrt em sistemas com glibc antiga.
+
+#define COMP_SHM_NAME         "/vga_compositor"
+#define COMP_SURFACE_NAME_FMT "/vga_surface_%d"
+#define COMP_MAGIC            0x43414756 // "VGAC"
+#define COMP_MAX_SURFACES     16
+#define COMP_RING_SIZE        256        // Potência de 2
+#define COMP_LWIDTH           512        // Stride das superfícies (igual ao da VGA)
+#define COMP_SCREEN_WIDTH     320
+#define COMP_SCREEN_HEIGHT    240
+
+// Estados de um slot de superfície
+enum { COMP_SLOT_FREE, COMP_SLOT_CLAIMED, COMP_SLOT_ACTIVE, COMP_SLOT_CLOSING };
+
+typedef struct {
+    int16_t x0, y0, x1, y1;     // Retângulo semiaberto [x0, x1) x [y0, y1)
+} CompRect;
+
+typedef struct {
+    _Atomic uint32_t state;
+    _Atomic int32_t pid;        // Dono do slot (gravado logo após reservá-lo; 0 = livre)
+    int32_t width, height;
+    _Atomic int32_t x, y, z;    // Posição na tela e ordem (maior z fica por cima)
+    _Atomic uint32_t head;      // Escrito só pelo cliente
+    _Atomic uint32_t tail;      // Escrito só pelo compositor
+    _Atomic uint32_t overflow;  // Anel cheio: o compositor redesenha a superfície inteira
+    CompRect ring[COMP_RING_SIZE];
+} CompSlot;
+
+typedef struct {
+    uint32_t magic;
+    CompSlot slots[COMP_MAX_SURFACES];
+} CompShared;
+
+typedef struct {
+    CompShared *shared;
+    CompSlot *slot;
+    int index;
+    uint16_t *pixels;           // pixels[y * COMP_LWIDTH + x]
+    size_t size;
+} CompSurface;
+
+static inline size_t comp_surface_bytes(int height) {
+    return (size_t)COMP_LWIDTH * height * sizeof(uint16_t);
+}
+
+/**
+ * @brief Registra uma superfície width x height na posição (x, y) com ordem z.
+ * @return 0 em sucesso, -1 se o compositor não está rodando ou não há slots.
+ */
+static inline int comp_surface_open(CompSurface *s, int x, int y, int width, int height, int z) {
+    memset(s, 0, sizeof(*s));
+    if (width <= 0 || width > COMP_SCREEN_WIDTH || height <= 0 || height > COMP_SCREEN_HEIGHT) return -1;
+
+    int fd = shm_open(COMP_SHM_NAME, O_RDWR, 0);
+    if (fd == -1) {
+        perror("Compositor nao encontrado");
+        return -1;
+    }
+    void *map = mmap(NULL, sizeof(CompShared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+    s->shared = (CompShared *)map;
+    if (s->shared->magic != COMP_MAGIC) {
+        munmap(map, sizeof(CompShared));
+        return -1;
+    }
+
+    // Reserva um slot livre sem trava (compare-and-swap)
+    for (s->index = 0; s->index < COMP_MAX_SURFACES; s->index++) {
+        uint32_t expected = COMP_SLOT_FREE;
+        if (atomic_compare_exchange_strong(&s->shared->slots[s->index].state, &expected, COMP_SLOT_CLAIMED)) break;
+    }
+    if (s->index == COMP_MAX_SURFACES) {
+        munmap(map, sizeof(CompShared));
+        return -1;
+    }
+    s->slot = &s->shared->slots[s->index];
+    // Já com dono: se o cliente morrer antes do ACTIVE, o compositor libera o slot
+    atomic_store(&s->slot->pid, getpid());
+
+    char name[32];
+    snprintf(name, sizeof(name), COMP_SURFACE_NAME_FMT, s->index);
+    s->size = comp_surface_bytes(height);
+    fd = shm_open(name, O_RDWR | O_CREAT, 0666);
+    if (fd == -1 || ftruncate(fd, s->size) != 0) {
+        if (fd != -1) close(fd);
+        atomic_store(&s->slot->pid, 0);
+        atomic_store(&s->slot->state, COMP_SLOT_FREE);
+        munmap(map, sizeof(CompShared));
+        return -1;
+    }
+    s->pixels = (uint16_t *)mmap(NULL, s->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if ((void *)s->pixels == MAP_FAILED) {
+        atomic_store(&s->slot->pid, 0);
+        atomic_store(&s->slot->state, COMP_SLOT_FREE);
+        munmap(map, sizeof(CompShared));
+        return -1;
+    }
+
+    s->slot->width = width;
+    s->slot->height = height;
+    atomic_store(&s->slot->x, x);
+    atomic_store(&s->slot->y, y);
+    atomic_store(&s->slot->z, z);
+    atomic_store(&s->slot->head, 0);
+    atomic_store(&s->slot->tail, 0);
+    atomic_store(&s->slot->overflow, 1); // Primeiro quadro: superfície inteira
+    atomic_store_explicit(&s->slot->state, COMP_SLOT_ACTIVE, memory_order_release);
+    return 0;
+}
+
+// Informa que a região [x0, x1) x [y0, y1) da superfície mudou
+static inline void comp_damage(CompSurface *s, int x0, int y0, int x1, int y1) {
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > s->slot->width) x1 = s->slot->width;
+    if (y1 > s->slot->height) y1 = s->slot->height;
+    if (x0 >= x1 || y0 >= y1) return;
+
+    uint32_t head = atomic_load_explicit(&s->slot->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&s->slot->tail, memory_order_acquire);
+    if (head - tail == COMP_RING_SIZE) {
+        atomic_store_explicit(&s->slot->overflow, 1, memory_order_release);
+        return;
+    }
+    CompRect *r = &s->slot->ring[head & (COMP_RING_SIZE - 1)];
+    r->x0 = x0; r->y0 = y0; r->x1 = x1; r->y1 = y1;
+    atomic_store_explicit(&s->slot->head, head + 1, memory_order_release);
+}
+
+// Move a superfície ou muda sua ordem z; o compositor redesenha as duas posições
+static inline void comp_surface_move(CompSurface *s, int x, int y, int z) {
+    atomic_store(&s->slot->x, x);
+    atomic_store(&s->slot->y, y);
+    atomic_store(&s->slot->z, z);
+}
+
+/**
+ * @brief Lê a geometria da variável VGA_COMPOSITOR ("x,y,z"; campos omitidos
+ * valem 0). Os programas usam o compositor apenas quando ela existe.
+ * @return 1 se a variável está definida, 0 caso contrário.
+ */
+static inline int comp_env_geometry(int *x, int *y, int *z) {
+    const char *env = getenv("VGA_COMPOSITOR");
+    if (env == NULL) return 0;
+    *x = 0; *y = 0; *z = 0;
+    sscanf(env, "%d,%d,%d", x, y, z);
+    return 1;
+}
+
+static inline void comp_surface_close(CompSurface *s) {
+    if (s->slot == NULL) return;
+    munmap(s->pixels, s->size);
+    atomic_store_explicit(&s->slot->state, COMP_SLOT_CLOSING, memory_order_release);
+    munmap(s->shared, sizeof(CompShared));
+    s->slot = NULL;
+}
+
+#endif
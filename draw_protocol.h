@@ -0,0 +1,122 @@
+#ifndef DRAW_PROTOCOL_H
+#define DRAW_PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// =================================================================================
+// --- PROTOCOLO BINÁRIO DE DESENHO ---
+// =================================================================================
+// Alternativa compacta aos comandos de texto ("LINE 10 10 310 230"). Cada
+// quadro é:
+//
+//   PROTO_MAGIC (1 byte) | opcode (1 byte) | argumentos (int16 little-endian)
+//
+// O byte mágico (0xA5) nunca aparece em texto ASCII, então quadros binários e
+// linhas de texto podem ser misturados no mesmo fluxo: um quadro só é
+// reconhecido no início de uma linha. As cores vão em RGB565, direto para o
+// framebuffer.
+//
+// Uso: #include "draw_protocol.h"; proto_decode() para buffers contíguos,
+// proto_feed() para bytes que chegam um a um, e proto_encode() para gerar.
+
+#define PROTO_MAGIC       0xA5
+#define PROTO_MAX_FRAME   14 // Mágico + opcode + 6 argumentos de 16 bits
+
+typedef enum {
+    PROTO_COLOR = 0x01, // cor (RGB565)
+    PROTO_LINE  = 0x02, // x0 y0 x1 y1
+    PROTO_CIRC  = 0x03, // xc yc r
+    PROTO_RECT  = 0x04, // x0 y0 x1 y1
+    PROTO_TILE  = 0x05, // x0 y0 x1 y1
+    PROTO_FILL  = 0x06, // sem argumentos (comando de texto FUNDO: pinta a tela toda)
+    PROTO_QUIT  = 0x07, // sem argumentos
+    PROTO_TRI   = 0x08, // x0 y0 x1 y1 x2 y2 (triângulo preenchido)
+    PROTO_FLOOD = 0x09, // x y (comando FLOOD: preenche a região que contém o ponto)
+    PROTO_COPY  = 0x0A, // x0 y0 x1 y1 dx dy (copia a região deslocada de dx, dy)
+    PROTO_MOVE  = 0x0B  // x0 y0 x1 y1 dx dy (idem, e pinta a origem com a cor atual)
+} ProtoOpcode;
+
+typedef struct {
+    uint8_t op;
+    int16_t args[6];    // Coordenadas; em PROTO_COLOR, args[0] é a cor RGB565
+} DrawCommand;
+
+typedef struct {
+    uint8_t frame[PROTO_MAX_FRAME];
+    int len;            // Bytes já recebidos do quadro atual (0 = nenhum)
+} ProtoDecoder;
+
+// Número de argumentos de 16 bits de cada opcode, ou -1 se for inválido
+static inline int proto_arg_count(uint8_t op) {
+    switch (op) {
+        case PROTO_COLOR: return 1;
+        case PROTO_LINE:  return 4;
+        case PROTO_CIRC:  return 3;
+        case PROTO_RECT:  return 4;
+        case PROTO_TILE:  return 4;
+        case PROTO_FILL:  return 0;
+        case PROTO_QUIT:  return 0;
+        case PROTO_TRI:   return 6;
+        case PROTO_FLOOD: return 2;
+        case PROTO_COPY:  return 6;
+        case PROTO_MOVE:  return 6;
+        default:          return -1;
+    }
+}
+
+static inline void proto_unpack(const uint8_t *frame, DrawCommand *cmd) {
+    cmd->op = frame[1];
+    int count = proto_arg_count(cmd->op);
+    for (int i = 0; i < count; i++) {
+        cmd->args[i] = (int16_t)(frame[2 + 2 * i] | (frame[3 + 2 * i] << 8));
+    }
+}
+
+/**
+ * @brief Decodifica um quadro no início de 'data' (que começa com PROTO_MAGIC).
+ * @return Bytes consumidos, 0 se o quadro ainda está incompleto, -1 se o opcode é inválido.
+ */
+static inline int proto_decode(const uint8_t *data, size_t size, DrawCommand *cmd) {
+    if (size < 2) return 0;
+    int count = proto_arg_count(data[1]);
+    if (count < 0) return -1;
+    size_t frame_size = 2 + 2 * count;
+    if (size < frame_size) return 0;
+    proto_unpack(data, cmd);
+    return (int)frame_size;
+}
+
+/**
+ * @brief Acrescenta um byte ao quadro em montagem (o primeiro deve ser PROTO_MAGIC).
+ * @return 1 se o quadro ficou completo (preenche 'cmd'), 0 se falta algo, -1 se inválido.
+ */
+static inline int proto_feed(ProtoDecoder *dec, uint8_t byte, DrawCommand *cmd) {
+    if (dec->len < 0 || dec->len >= PROTO_MAX_FRAME) dec->len = 0;
+    dec->frame[dec->len++] = byte;
+    if (dec->len < 2) return 0;
+    int count = proto_arg_count(dec->frame[1]);
+    if (count < 0) {
+        dec->len = 0;
+        return -1;
+    }
+    if (dec->len < 2 + 2 * count) return 0;
+    proto_unpack(dec->frame, cmd);
+    dec->len = 0;
+    return 1;
+}
+
+// Gera o quadro de 'cmd' em 'out' (pelo menos PROTO_MAX_FRAME bytes). Retorna o tamanho.
+static inline int proto_encode(const DrawCommand *cmd, uint8_t *out) {
+    int count = proto_arg_count(cmd->op);
+    if (count < 0) return 0;
+    out[0] = PROTO_MAGIC;
+    out[1] = cmd->op;
+    for (int i = 0; i < count; i++) {
+        out[2 + 2 * i] = (uint16_t)cmd->args[i] & 0xFF;
+        out[3 + 2 * i] = (uint16_t)cmd->args[i] >> 8;
+    }
+    return 2 + 2 * count;
+}
+
+#endif
@@ -4,19 +4,20 @@
 #include <string.h>
 #include <stdint.h>
 #include <unistd.h>
-#include <fcntl.h>
-#include <sys/mman.h>
 #include <time.h>
 #include <math.h>
+#include "hardware.h"
+#include "key_input.h"
+#include "perf_hud.h"
+#include "blit.h"
+#include "sprite.h"
+#include "indexed.h"
+#include "frame_diff.h"
+#include "text_overlay.h"
 
 // =================================================================================
 // --- CONFIGURAÇÕES DE HARDWARE E TELA ---
 // =================================================================================
-#define PERIPHERAL_BASE 0xFF200000
-#define PERIPHERAL_SIZE 0x00010000 
-#define DEVICES_BUTTONS 0x0050
-
-#define FRAME_BASE      0xC8000000
 #define LWIDTH          512
 #define VISIBLE_WIDTH   320
 #define VISIBLE_HEIGHT  240
@@ -44,22 +45,13 @@
 #define P2_COLOR 0x349F // Azul
 #define DEAD_COLOR 0x8410 // Cinza
 #define SKY_BLUE 0x841F
+#define SPRITE_KEY 0xF81F // Magenta: cor transparente dos sprites
+#define DUSK_COLOR 0xFB2C // Céu do entardecer (salmão)
 
-// =================================================================================
-// --- DEFINIÇÕES DA FONTE (para o placar) ---
-// =================================================================================
-#define FONT_WIDTH 3
-#define FONT_HEIGHT 5
-#define FONT_CHAR_SPACING 2 
-#define FONT_SCALE 2        
-
-const int font_3x5[10][FONT_HEIGHT][FONT_WIDTH] = {
-    {{1,1,1},{1,0,1},{1,0,1},{1,0,1},{1,1,1}}, {{0,1,0},{1,1,0},{0,1,0},{0,1,0},{1,1,1}}, 
-    {{1,1,1},{0,0,1},{1,1,1},{1,0,0},{1,1,1}}, {{1,1,1},{0,0,1},{0,1,1},{0,0,1},{1,1,1}}, 
-    {{1,0,1},{1,0,1},{1,1,1},{0,0,1},{0,0,1}}, {{1,1,1},{1,0,0},{1,1,1},{0,0,1},{1,1,1}},
-    {{1,1,1},{1,0,0},{1,1,1},{1,0,1},{1,1,1}}, {{1,1,1},{0,0,1},{0,1,0},{0,1,0},{0,1,0}},
-    {{1,1,1},{1,0,1},{1,1,1},{1,0,1},{1,1,1}}, {{1,1,1},{1,0,1},{1,1,1},{0,0,1},{1,1,1}}
-};
+// Placar e mensagens no buffer de caracteres (linha/coluna de 4x4 pixels)
+#define SCORE_ROW       2
+#define SCORE_END_COL   (TEXT_COLS - 2)
+#define MESSAGE_ROW     27
 
 // =================================================================================
 // --- ESTRUTURAS E ESTADOS DE JOGO ---
@@ -71,33 +63,68 @@ typedef struct { int x, gap_y, scored; } Obstacle;
 // =================================================================================
 // --- VARIÁVEIS GLOBAIS DE HARDWARE ---
 // =================================================================================
-int mem_fd = -1;
 volatile uint16_t (*tela)[LWIDTH] = NULL;
-volatile void *peripheral_map = NULL;
-volatile unsigned int *key_ptr = NULL;
+KeyInput keys; // Botões via edge-capture (ver key_input.h)
+PerfHud hud;   // FPS nos displays e carga nos LEDs (ver perf_hud.h)
+TextOverlay text; // Placar e mensagens (ver text_overlay.h)
+
+// Pássaros pré-desenhados em spans opacos (ver sprite.h)
+SpriteAtlas sprites;
+int bird_sprite[3];            // Jogador 1, jogador 2, morto
+
+// =================================================================================
+// --- CENÁRIO EM CACHE (MODO SCROLL) ---
+// =================================================================================
+// Céu e canos ficam num buffer indexado de 8 bits em memória comum (ver
+// indexed.h). A cada quadro o buffer é deslocado OBSTACLE_SPEED pixels para a
+// esquerda e só a faixa nova da borda direita é desenhada; a paleta converte
+// para RGB565 na cópia para a tela. Os pássaros vão direto para a tela
+// e o placar é texto no buffer de caracteres.
+//
+// Efeitos só de paleta, sem redesenhar nenhum pixel: o céu escurece para o
+// entardecer conforme a pontuação e os canos piscam em branco a cada ponto.
+#define PAL_SKY          0
+#define PAL_PIPE         1
+#define DUSK_SCORE       30 // Pontuação em que o céu chega ao entardecer
+#define PIPE_FLASH       12 // Quadros do clarão dos canos ao pontuar
+
+int scroll_mode = 1;            // 0 = redesenho completo (./flappy --full-redraw)
+int playfield_valid = 0;        // 0 = o buffer precisa ser reconstruído
+uint8_t playfield[VISIBLE_HEIGHT][VISIBLE_WIDTH];
+Palette palette;
+int pipe_flash = 0;             // Quadros restantes do clarão dos canos
+int palette_fading = 0;         // 1 = a paleta muda de novo no próximo quadro
+
+// Com ./flappy --diff-present só os trechos do cenário que mudaram vão para a
+// tela (ver frame_diff.h): no céu parado quase nada muda, só as bordas dos
+// canos e onde estavam os pássaros. O ganho depende do custo de cada escrita
+// na VGA, que fora da placa só é estimado (./flappy --bench-diff mede os dois
+// modos na VGA quando roda na placa); até ser medido lá, o padrão é a cópia
+// inteira.
+int diff_mode = 0;              // 0 = cópia do quadro inteiro (./flappy --full-present)
+FrameDiff diff;
+uint8_t presented[VISIBLE_HEIGHT][VISIBLE_WIDTH];
+unsigned long diff_rows = 0, diff_frames = 0; // Linhas escritas no jogo atual
+unsigned long present_stores = 0;             // Escritas no framebuffer no último present
 
 // =================================================================================
 // --- FUNÇÕES DE HARDWARE E DESENHO ---
 // =================================================================================
 void cleanup_resources() {
-    if (tela) munmap((void*)tela, LWIDTH * VISIBLE_HEIGHT * PIXEL_SIZE);
-    if (peripheral_map) munmap((void*)peripheral_map, PERIPHERAL_SIZE);
-    if (mem_fd != -1) close(mem_fd);
+    key_input_close(&keys);
+    hud_close(&hud);
+    text_clear(&text);
+    sprite_atlas_free(&sprites);
+    hw_close();
     printf("\nRecursos liberados. Saindo do jogo.\n");
 }
 
 int init_hardware() {
-    mem_fd = open("/dev/mem", O_RDWR | O_SYNC);
-    if (mem_fd == -1) { perror("Erro ao abrir /dev/mem"); return -1; }
-    
-    void* vga_map = mmap(NULL, LWIDTH * VISIBLE_HEIGHT * PIXEL_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, FRAME_BASE);
-    if (vga_map == MAP_FAILED) { perror("Erro ao mapear VGA"); close(mem_fd); return -1; }
-    tela = (volatile uint16_t (*)[LWIDTH])vga_map;
-
-    peripheral_map = mmap(NULL, PERIPHERAL_SIZE, PROT_READ, MAP_SHARED, mem_fd, PERIPHERAL_BASE);
-    if (peripheral_map == MAP_FAILED) { perror("Erro ao mapear periféricos"); munmap(vga_map, LWIDTH * VISIBLE_HEIGHT * PIXEL_SIZE); close(mem_fd); return -1; }
-    
-    key_ptr = (volatile unsigned int *)(peripheral_map + DEVICES_BUTTONS);
+    if (hw_init() != 0) return -1;
+    tela = hw_framebuffer();
+    key_input_init(&keys, hw_reg(KEY_OFFSET));
+    hud_init(&hud, hw_reg(HEX3_0_OFFSET), hw_reg(HEX5_4_OFFSET), hw_reg(LEDR_OFFSET), hw_reg(SW_OFFSET));
+    text_init(&text, hw_charbuffer());
 
     atexit(cleanup_resources);
     return 0;
@@ -117,14 +144,28 @@ void draw_filled_rect(int x0, int y0, int x1, int y1, uint16_t color) {
     }
 }
 
-void draw_circle(int xc, int yc, int r, uint16_t color) {
-    for (int y = -r; y <= r; y++) {
-        for (int x = -r; x <= r; x++) {
-            if (x * x + y * y <= r * r) {
-                set_pix(xc + x, yc + y, color);
+// Desenha os discos dos pássaros uma vez; no jogo eles viram cópias de spans
+int build_sprites() {
+    static const uint16_t colors[3] = { P1_COLOR, P2_COLOR, DEAD_COLOR };
+    const int size = 2 * BIRD_RADIUS + 1;
+    uint16_t disc[2 * BIRD_RADIUS + 1][2 * BIRD_RADIUS + 1];
+    sprite_atlas_init(&sprites);
+    for (int i = 0; i < 3; i++) {
+        for (int y = -BIRD_RADIUS; y <= BIRD_RADIUS; y++) {
+            for (int x = -BIRD_RADIUS; x <= BIRD_RADIUS; x++) {
+                disc[y + BIRD_RADIUS][x + BIRD_RADIUS] = (x * x + y * y <= BIRD_RADIUS * BIRD_RADIUS) ? colors[i] : SPRITE_KEY;
             }
         }
+        bird_sprite[i] = sprite_add(&sprites, &disc[0][0], size, size, size, SPRITE_KEY);
+        if (bird_sprite[i] < 0) return -1;
     }
+    return 0;
+}
+
+// Pássaro centrado em (xc, yc), direto na tela
+void draw_bird(int xc, int yc, int sprite) {
+    sprite_draw_device(&sprites, sprite, &tela[0][0], LWIDTH, VISIBLE_WIDTH, VISIBLE_HEIGHT, xc - BIRD_RADIUS, yc - BIRD_RADIUS);
+    frame_diff_damage(&diff, xc - BIRD_RADIUS, yc - BIRD_RADIUS, xc + BIRD_RADIUS + 1, yc + BIRD_RADIUS + 1);
 }
 
 void fill_screen(uint16_t color) {
@@ -135,32 +176,66 @@ void fill_screen(uint16_t color) {
     }
 }
 
-void draw_digit(int digit, int x, int y, uint16_t color) {
-    if (digit < 0 || digit > 9) return;
-    for (int row = 0; row < FONT_HEIGHT; row++) {
-        for (int col = 0; col < FONT_WIDTH; col++) {
-            if (font_3x5[digit][row][col] == 1) {
-                draw_filled_rect(x + (col * FONT_SCALE), y + (row * FONT_SCALE),
-                                 x + (col * FONT_SCALE) + FONT_SCALE, y + (row * FONT_SCALE) + FONT_SCALE,
-                                 color);
-            }
-        }
+// Desenha céu e canos nas colunas [x0, x1) do buffer do cenário
+void render_playfield_columns(const Obstacle obstacles[], int x0, int x1) {
+    IndexedSurface field = indexed_surface(playfield, VISIBLE_WIDTH, VISIBLE_WIDTH, VISIBLE_HEIGHT);
+    indexed_fill_rect(&field, x0, 0, x1, VISIBLE_HEIGHT, PAL_SKY);
+    for (int i = 0; i < 2; i++) {
+        int start = obstacles[i].x > x0 ? obstacles[i].x : x0;
+        int end = obstacles[i].x + OBSTACLE_WIDTH < x1 ? obstacles[i].x + OBSTACLE_WIDTH : x1;
+        indexed_fill_rect(&field, start, 0, end, obstacles[i].gap_y, PAL_PIPE);
+        indexed_fill_rect(&field, start, obstacles[i].gap_y + GAP_HEIGHT, end, VISIBLE_HEIGHT, PAL_PIPE);
     }
 }
 
-void draw_score(int score, int x, int y, uint16_t color) {
-    char score_text[10];
-    sprintf(score_text, "%d", score);
-    int len = strlen(score_text);
-    int current_x = x;
-
-    for (int i = len - 1; i >= 0; i--) {
-        int digit = score_text[i] - '0';
-        int char_width = (FONT_WIDTH * FONT_SCALE);
-        current_x -= char_width;
-        draw_digit(digit, current_x, y, color);
-        current_x -= FONT_CHAR_SPACING;
+// Avança o cenário um quadro: desloca as linhas e desenha a faixa exposta
+void scroll_playfield(const Obstacle obstacles[]) {
+    if (!playfield_valid) {
+        render_playfield_columns(obstacles, 0, VISIBLE_WIDTH);
+        playfield_valid = 1;
+        return;
+    }
+    IndexedSurface field = indexed_surface(playfield, VISIBLE_WIDTH, VISIBLE_WIDTH, VISIBLE_HEIGHT);
+    indexed_copy(&field, OBSTACLE_SPEED, 0, VISIBLE_WIDTH - OBSTACLE_SPEED, VISIBLE_HEIGHT, 0, 0);
+    render_playfield_columns(obstacles, VISIBLE_WIDTH - OBSTACLE_SPEED, VISIBLE_WIDTH);
+}
+
+// Cores do quadro: céu pela pontuação, canos pelo clarão restante
+void update_palette(int score) {
+    int dusk = score < DUSK_SCORE ? score * 256 / DUSK_SCORE : 256;
+    uint16_t sky = palette_blend(SKY_BLUE, DUSK_COLOR, dusk);
+    uint16_t pipe = palette_blend(GREEN, WHITE, pipe_flash * 256 / PIPE_FLASH);
+    palette_fading = pipe_flash > 0;
+    if (pipe_flash > 0) pipe_flash--;
+    // Mesmos índices, outras cores: a tela inteira precisa ser reescrita. Uma
+    // invalidação por mudança: durante o clarão present_playfield() não compara
+    // e a cópia de referência só é refeita no último quadro do clarão
+    if ((sky != palette.color[PAL_SKY] || pipe != palette.color[PAL_PIPE]) && diff.valid) frame_diff_invalidate(&diff);
+    palette.color[PAL_SKY] = sky;
+    palette.color[PAL_PIPE] = pipe;
+}
+
+// Copia o cenário para a tela pela paleta, quatro pixels por escrita de 64 bits
+void present_playfield() {
+    if (diff_mode && !palette_fading) {
+        diff_rows += frame_diff_present(&diff, playfield, VISIBLE_WIDTH, &palette, &tela[0][0], LWIDTH);
+        present_stores = diff.stores_written;
+    } else {
+        IndexedSurface field = indexed_surface(playfield, VISIBLE_WIDTH, VISIBLE_WIDTH, VISIBLE_HEIGHT);
+        BlitRect all = { 0, 0, VISIBLE_WIDTH, VISIBLE_HEIGHT };
+        indexed_present(&field, &palette, &tela[0][0], LWIDTH, &all);
+        diff_rows += VISIBLE_HEIGHT;
+        present_stores = (unsigned long)VISIBLE_HEIGHT * blit_store_count(&tela[0][0], VISIBLE_WIDTH);
     }
+    diff_frames++;
+}
+
+// Placar no canto superior direito, em texto sobreposto pela VGA: só os
+// dígitos que mudam são escritos e o cenário embaixo não é tocado
+void draw_score(int score) {
+    char score_text[16];
+    snprintf(score_text, sizeof(score_text), "%6d", score);
+    text_print_right(&text, SCORE_END_COL, SCORE_ROW, score_text);
 }
 
 // =================================================================================
@@ -188,6 +263,12 @@ void reset_game(Bird* p1, Bird* p2, Obstacle obstacles[], int* score) {
     p2->alive = 1;
 
     *score = 0;
+    pipe_flash = 0;
+    diff_rows = 0;
+    diff_frames = 0;
+    text_clear_line(&text, MESSAGE_ROW);
+    text_clear_line(&text, MESSAGE_ROW + 2);
+    playfield_valid = 0; // Obstáculos novos: o cenário em cache é descartado
 
     for (int i = 0; i < 2; i++) {
         obstacles[i].x = VISIBLE_WIDTH + 150 + i * OBSTACLE_SPACING;
@@ -198,8 +279,232 @@ void reset_game(Bird* p1, Bird* p2, Obstacle obstacles[], int* score) {
     fflush(stdout); // Garante que a mensagem seja impressa antes de qualquer possível falha
 }
 
-int main() {
+// =================================================================================
+// --- BENCHMARK DE SPRITES (RLE x COR-CHAVE POR PIXEL) ---
+// =================================================================================
+// Desenha a mesma lista de sprites (formas com bastante transparência, parte
+// delas saindo da tela) com o atlas RLE e com um blit que testa a cor-chave
+// de cada pixel, em buffers comuns, e confere que as imagens são iguais.
+#define SPRITE_BENCH_SHAPES 8
+#define SPRITE_BENCH_SIZE   24
+#define SPRITE_BENCH_COUNT  2000
+#define SPRITE_BENCH_FRAMES 50
+
+// Referência: recorte por sprite e teste da cor-chave em cada pixel
+void colorkey_blit(const uint16_t *src, int w, int h, uint16_t (*dst)[VISIBLE_WIDTH], int x, int y) {
+    int x0 = x < 0 ? -x : 0, x1 = x + w > VISIBLE_WIDTH ? VISIBLE_WIDTH - x : w;
+    int y0 = y < 0 ? -y : 0, y1 = y + h > VISIBLE_HEIGHT ? VISIBLE_HEIGHT - y : h;
+    for (int row = y0; row < y1; row++) {
+        for (int col = x0; col < x1; col++) {
+            uint16_t c = src[row * w + col];
+            if (c != SPRITE_KEY) dst[y + row][x + col] = c;
+        }
+    }
+}
+
+void run_sprite_benchmark() {
+    static uint16_t shapes[SPRITE_BENCH_SHAPES][SPRITE_BENCH_SIZE * SPRITE_BENCH_SIZE];
+    static uint16_t rle_out[VISIBLE_HEIGHT][VISIBLE_WIDTH], key_out[VISIBLE_HEIGHT][VISIBLE_WIDTH];
+    static const uint16_t colors[] = { P1_COLOR, P2_COLOR, DEAD_COLOR, GREEN, WHITE, SKY_BLUE, DUSK_COLOR, 0xF800 };
+    const int n = SPRITE_BENCH_SIZE, c = SPRITE_BENCH_SIZE / 2;
+
+    // Disco, anel, losango, cruz, xadrez de blocos... (cores sólidas + listras)
+    SpriteAtlas atlas;
+    sprite_atlas_init(&atlas);
+    long opaque = 0;
+    for (int s = 0; s < SPRITE_BENCH_SHAPES; s++) {
+        for (int y = 0; y < n; y++) {
+            for (int x = 0; x < n; x++) {
+                int dx = x - c, dy = y - c, d2 = dx * dx + dy * dy, inside;
+                switch (s % 4) {
+                    case 0:  inside = d2 <= c * c; break;
+                    case 1:  inside = d2 <= c * c && d2 >= (c / 2) * (c / 2); break;
+                    case 2:  inside = abs(dx) + abs(dy) <= c; break;
+                    default: inside = abs(dx) < 3 || abs(dy) < 3 || ((x / 6 + y / 6) % 2 == 0 && s > 4); break;
+                }
+                shapes[s][y * n + x] = inside ? (uint16_t)(colors[s] ^ (y & 1)) : SPRITE_KEY;
+                opaque += inside;
+            }
+        }
+        sprite_add(&atlas, shapes[s], n, n, n, SPRITE_KEY);
+    }
+
+    SpriteDraw *draws = malloc(SPRITE_BENCH_COUNT * sizeof(SpriteDraw));
+    if (draws == NULL) {
+        perror("malloc");
+        return;
+    }
+    srand(1);
+    for (int i = 0; i < SPRITE_BENCH_COUNT; i++) {
+        draws[i] = (SpriteDraw){ rand() % SPRITE_BENCH_SHAPES, rand() % (VISIBLE_WIDTH + n) - n, rand() % (VISIBLE_HEIGHT + n) - n };
+    }
+
+    BlitSurface surface = blit_surface(rle_out, VISIBLE_WIDTH, VISIBLE_WIDTH, VISIBLE_HEIGHT);
+    struct timespec start, end;
+    double seconds[2];
+    BlitRect bounds;
+    for (int k = 0; k < 2; k++) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int frame = 0; frame < SPRITE_BENCH_FRAMES; frame++) {
+            if (k == 0) {
+                sprite_draw_batch(&atlas, draws, SPRITE_BENCH_COUNT, &surface, &bounds);
+            } else {
+                for (int i = 0; i < SPRITE_BENCH_COUNT; i++) {
+                    colorkey_blit(shapes[draws[i].id], n, n, key_out, draws[i].x, draws[i].y);
+                }
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        seconds[k] = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    }
+
+    double total = (double)SPRITE_BENCH_COUNT * SPRITE_BENCH_FRAMES;
+    size_t atlas_bytes = atlas.row_count * sizeof(SpriteRow) + atlas.span_count * sizeof(SpriteSpan) +
+                         atlas.pixel_count * sizeof(uint16_t);
+    printf("%d sprites %dx%d por quadro (%.0f%% transparente), %d quadros\n", SPRITE_BENCH_COUNT, n, n,
+           100.0 - 100.0 * opaque / (SPRITE_BENCH_SHAPES * n * n), SPRITE_BENCH_FRAMES);
+    printf("%-14s %14s %14s\n", "blitter", "ns/sprite", "sprites/s");
+    printf("%-14s %14.1f %14.0f\n", "RLE", seconds[0] / total * 1e9, total / seconds[0]);
+    printf("%-14s %14.1f %14.0f\n", "cor-chave", seconds[1] / total * 1e9, total / seconds[1]);
+    printf("RLE: %.1fx mais rapido; atlas com %zu bytes (imagens cruas: %zu); imagens %s\n", seconds[1] / seconds[0],
+           atlas_bytes, sizeof(shapes), memcmp(rle_out, key_out, sizeof(rle_out)) == 0 ? "identicas" : "DIFERENTES");
+    free(draws);
+    sprite_atlas_free(&atlas);
+}
+
+// =================================================================================
+// --- BENCHMARK DA APRESENTAÇÃO POR DIFERENÇA ---
+// =================================================================================
+// Roda o cenário do jogo (rolagem dos canos, pássaros subindo e descendo e,
+// no segundo cenário, pontos com o clarão e o entardecer da paleta) e
+// apresenta cada quadro com present_playfield() nos dois modos. Só a
+// apresentação entra no tempo; as telas são conferidas no fim.
+//
+// O que a diferença economiza são escritas no framebuffer O_SYNC. Com a VGA
+// mapeada (na placa) o tempo medido já inclui esse custo; fora dela a "tela"
+// é memória comum e cada escrita recebe um custo fixo (argumento, em ns) para
+// estimar a placa. O empate diz a partir de quantos ns por escrita a
+// comparação compensa, qualquer que seja o custo real.
+#define DIFF_BENCH_FRAMES   600
+#define DIFF_BENCH_STORE_NS 100.0  // Custo estimado de uma escrita na VGA fora da placa
+
+double bench_seconds(const struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+void run_diff_benchmark(double store_ns) {
+    static uint16_t offscreen[VISIBLE_HEIGHT][LWIDTH] __attribute__((aligned(64)));
+    static uint16_t full_image[VISIBLE_HEIGHT][VISIBLE_WIDTH];
+    static const char *names[] = { "rolagem", "rolagem + pontos" };
+
+    int mapped = hw_init() == 0;
+#if defined(HW_SIM)
+    int on_vga = 0; // O framebuffer simulado também é memória comum
+#else
+    int on_vga = mapped;
+#endif
+    tela = mapped ? hw_framebuffer() : offscreen;
+    if (on_vga) store_ns = 0;
+    frame_diff_init(&diff, presented, VISIBLE_WIDTH, VISIBLE_HEIGHT, 1);
+    printf("Tela: %s; %d quadros por cenario\n",
+           on_vga ? "VGA (" HW_BACKEND_NAME ")" : "memoria comum", DIFF_BENCH_FRAMES);
+    if (!on_vga) printf("Custo somado por escrita no framebuffer: %.0f ns\n", store_ns);
+    printf("%-18s %12s %12s %14s %14s %12s %10s\n", "cenario", "inteiro(us)", "diferenca(us)",
+           "escritas(int.)", "escritas(dif.)", "empate(ns)", "tela");
+
+    for (int scenario = 0; scenario < 2; scenario++) {
+        double cpu[2], stores[2];
+        for (int k = 0; k < 2; k++) {
+            Obstacle obstacles[2];
+            int score = 0;
+            srand(7);
+            for (int i = 0; i < 2; i++) {
+                obstacles[i].x = VISIBLE_WIDTH + 150 + i * OBSTACLE_SPACING;
+                obstacles[i].gap_y = rand() % (VISIBLE_HEIGHT - GAP_HEIGHT - 60) + 30;
+                obstacles[i].scored = 0;
+            }
+            diff_mode = k;
+            playfield_valid = 0;
+            pipe_flash = 0;
+            frame_diff_invalidate(&diff);
+            cpu[k] = stores[k] = 0;
+            for (int f = 0; f < DIFF_BENCH_FRAMES; f++) {
+                for (int i = 0; i < 2; i++) {
+                    obstacles[i].x -= OBSTACLE_SPEED;
+                    if (scenario == 1 && !obstacles[i].scored && obstacles[i].x + OBSTACLE_WIDTH < P1_X_POS) {
+                        obstacles[i].scored = 1;
+                        score++;
+                        pipe_flash = PIPE_FLASH;
+                    }
+                    if (obstacles[i].x + OBSTACLE_WIDTH < 0) {
+                        obstacles[i].x = VISIBLE_WIDTH;
+                        obstacles[i].gap_y = rand() % (VISIBLE_HEIGHT - GAP_HEIGHT - 60) + 30;
+                        obstacles[i].scored = 0;
+                    }
+                }
+                update_palette(score);
+                scroll_playfield(obstacles);
+
+                struct timespec start;
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                present_playfield();
+                // Pássaros: só a marcação do dano entra (o desenho é igual nos dois modos)
+                for (int b = 0; b < 2; b++) {
+                    int yc = VISIBLE_HEIGHT / 2 + (int)(60 * sin((f + 40 * b) * 0.07)), xc = b ? P2_X_POS : P1_X_POS;
+                    frame_diff_damage(&diff, xc - BIRD_RADIUS, yc - BIRD_RADIUS, xc + BIRD_RADIUS + 1, yc + BIRD_RADIUS + 1);
+                }
+                cpu[k] += bench_seconds(&start);
+                if (f > 0) stores[k] += present_stores; // O primeiro quadro é sempre escrito inteiro
+            }
+            if (k == 0) {
+                for (int y = 0; y < VISIBLE_HEIGHT; y++) for (int x = 0; x < VISIBLE_WIDTH; x++) full_image[y][x] = tela[y][x];
+            }
+        }
+        int same = 1;
+        for (int y = 0; y < VISIBLE_HEIGHT && same; y++) {
+            for (int x = 0; x < VISIBLE_WIDTH; x++) {
+                if (tela[y][x] != full_image[y][x]) { same = 0; break; }
+            }
+        }
+        double per_frame[2];
+        for (int k = 0; k < 2; k++) per_frame[k] = (cpu[k] + stores[k] * store_ns / 1e9) / DIFF_BENCH_FRAMES * 1e6;
+        printf("%-18s %12.1f %12.1f %14.0f %14.0f ", names[scenario], per_frame[0], per_frame[1],
+               stores[0] / (DIFF_BENCH_FRAMES - 1), stores[1] / (DIFF_BENCH_FRAMES - 1));
+        // Empate: custo por escrita em que as duas colunas de tempo se igualam
+        if (on_vga) printf("%12s", "-");
+        else if (cpu[1] <= cpu[0]) printf("%12s", "sempre");
+        else if (stores[0] <= stores[1]) printf("%12s", "nunca");
+        else printf("%12.1f", (cpu[1] - cpu[0]) * 1e9 / (stores[0] - stores[1]));
+        printf(" %10s\n", same ? "igual" : "DIFERENTE");
+    }
+    diff_mode = 0;
+    if (mapped) hw_close();
+}
+
+int main(int argc, char *argv[]) {
+    // Uso: ./flappy --bench-sprites (atlas RLE x cor-chave por pixel, em memória)
+    if (argc > 1 && strcmp(argv[1], "--bench-sprites") == 0) {
+        run_sprite_benchmark();
+        return 0;
+    }
+
+    // Uso: ./flappy --bench-diff [ns por escrita] (cópia inteira x só as diferenças)
+    if (argc > 1 && strcmp(argv[1], "--bench-diff") == 0) {
+        run_diff_benchmark(argc > 2 ? atof(argv[2]) : DIFF_BENCH_STORE_NS);
+        return 0;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--full-redraw") == 0) scroll_mode = 0;
+        if (strcmp(argv[i], "--full-present") == 0) diff_mode = 0;
+        if (strcmp(argv[i], "--diff-present") == 0) diff_mode = 1;
+    }
+
     if (init_hardware() != 0) { return 1; }
+    if (build_sprites() != 0) { return 1; }
+    frame_diff_init(&diff, presented, VISIBLE_WIDTH, VISIBLE_HEIGHT, 1);
 
     srand(time(NULL));
 
@@ -207,33 +512,27 @@ int main() {
     Obstacle obstacles[2];
     int score;
     GameState state = GAME_RUNNING;
-    
-    unsigned int prev_key_state = 0x0;
 
     reset_game(&player1, &player2, obstacles, &score);
 
     while (1) {
-        unsigned int current_key_state = *key_ptr;
-        
-        if (current_key_state & 0b0001) { break; } 
+        hud_frame_begin(&hud);
+
+        // Cliques capturados desde o último quadro (nenhum é perdido entre quadros)
+        KeyEvent ev;
+        unsigned int pressed = key_poll(&keys, &ev) ? ev.keys : 0;
+
+        if (pressed & 0b0001) { break; } 
 
         switch(state) {
             case GAME_RUNNING: {
                 // Pulo do Jogador 1 (KEY1)
-                if (player1.alive) {
-                    int key1_pressed_now = (current_key_state & 0b0010);
-                    int key1_pressed_before = (prev_key_state & 0b0010);
-                    if (key1_pressed_now && !key1_pressed_before) {
-                        player1.velocity_y = JUMP_VELOCITY;
-                    }
+                if (player1.alive && (pressed & 0b0010)) {
+                    player1.velocity_y = JUMP_VELOCITY;
                 }
                 // Pulo do Jogador 2 (KEY2)
-                if (player2.alive) {
-                    int key2_pressed_now = (current_key_state & 0b0100);
-                    int key2_pressed_before = (prev_key_state & 0b0100);
-                    if (key2_pressed_now && !key2_pressed_before) {
-                        player2.velocity_y = JUMP_VELOCITY;
-                    }
+                if (player2.alive && (pressed & 0b0100)) {
+                    player2.velocity_y = JUMP_VELOCITY;
                 }
 
                 // Física do Jogador 1
@@ -253,6 +552,7 @@ int main() {
                     if (!obstacles[i].scored && obstacles[i].x + OBSTACLE_WIDTH < P1_X_POS) {
                         obstacles[i].scored = 1;
                         score++;
+                        pipe_flash = PIPE_FLASH;
                         printf("Pontuacao: %d\n", score);
                     }
                     if (obstacles[i].x + OBSTACLE_WIDTH < 0) {
@@ -277,22 +577,33 @@ int main() {
                 if (!player1.alive && !player2.alive) {
                     state = GAME_OVER;
                     printf("FIM DE JOGO! Pontuacao Final: %d. Pressione KEY1 ou KEY2 para reiniciar.\n", score);
+                    text_print_center(&text, MESSAGE_ROW, "FIM DE JOGO");
+                    text_print_center(&text, MESSAGE_ROW + 2, "KEY1 ou KEY2 para reiniciar");
+                    if (scroll_mode && diff_frames > 0) {
+                        printf("Linhas escritas por quadro: %.1f de %d\n", (double)diff_rows / diff_frames, VISIBLE_HEIGHT);
+                    }
                 }
 
                 // Desenhar tudo
-                fill_screen(SKY_BLUE);
-                for (int i = 0; i < 2; i++) {
-                    draw_filled_rect(obstacles[i].x, 0, obstacles[i].x + OBSTACLE_WIDTH, obstacles[i].gap_y, GREEN);
-                    draw_filled_rect(obstacles[i].x, obstacles[i].gap_y + GAP_HEIGHT, obstacles[i].x + OBSTACLE_WIDTH, VISIBLE_HEIGHT, GREEN);
+                update_palette(score);
+                if (scroll_mode) {
+                    scroll_playfield(obstacles);
+                    present_playfield();
+                } else {
+                    fill_screen(palette.color[PAL_SKY]);
+                    for (int i = 0; i < 2; i++) {
+                        draw_filled_rect(obstacles[i].x, 0, obstacles[i].x + OBSTACLE_WIDTH, obstacles[i].gap_y, palette.color[PAL_PIPE]);
+                        draw_filled_rect(obstacles[i].x, obstacles[i].gap_y + GAP_HEIGHT, obstacles[i].x + OBSTACLE_WIDTH, VISIBLE_HEIGHT, palette.color[PAL_PIPE]);
+                    }
                 }
-                draw_circle(P1_X_POS, (int)player1.y, BIRD_RADIUS, player1.alive ? P1_COLOR : DEAD_COLOR);
-                draw_circle(P2_X_POS, (int)player2.y, BIRD_RADIUS, player2.alive ? P2_COLOR : DEAD_COLOR);
-                draw_score(score, VISIBLE_WIDTH - 10, 10, WHITE);
+                draw_bird(P1_X_POS, (int)player1.y, player1.alive ? bird_sprite[0] : bird_sprite[2]);
+                draw_bird(P2_X_POS, (int)player2.y, player2.alive ? bird_sprite[1] : bird_sprite[2]);
+                draw_score(score);
                 break;
             } 
 
             case GAME_OVER: {
-                int restart_key_pressed = (current_key_state & 0b0110) && !(prev_key_state & 0b0110);
+                int restart_key_pressed = pressed & 0b0110;
                 if (restart_key_pressed) {
                     reset_game(&player1, &player2, obstacles, &score);
                     state = GAME_RUNNING;
@@ -301,8 +612,14 @@ int main() {
             }
         } 
 
-        prev_key_state = current_key_state;
-        usleep(16666);
+        if (state == GAME_RUNNING) {
+            hud_frame_end(&hud);
+            usleep(16666);
+        } else {
+            // Fim de jogo: dorme até o próximo clique (a espera não entra na média)
+            key_wait(&keys, -1);
+            hud_restart(&hud);
+        }
     }
     
     return 0;
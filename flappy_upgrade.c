@@ -4,19 +4,13 @@
 #include <string.h>
 #include <stdint.h>
 #include <unistd.h>
-#include <fcntl.h>
-#include <sys/mman.h>
 #include <time.h>
 #include <math.h>
+#include "hardware.h"
 
 // =================================================================================
 // --- CONFIGURAÇÕES DE HARDWARE E TELA ---
 // =================================================================================
-#define PERIPHERAL_BASE 0xFF200000
-#define PERIPHERAL_SIZE 0x00010000 
-#define DEVICES_BUTTONS 0x0050
-
-#define FRAME_BASE      0xC8000000
 #define LWIDTH          512
 #define VISIBLE_WIDTH   320
 #define VISIBLE_HEIGHT  240
@@ -74,33 +68,21 @@ typedef struct { int x, gap_y, scored; } Obstacle;
 // =================================================================================
 // --- VARIÁVEIS GLOBAIS DE HARDWARE ---
 // =================================================================================
-int mem_fd = -1;
 volatile uint16_t (*tela)[LWIDTH] = NULL;
-volatile void *peripheral_map = NULL;
 volatile unsigned int *key_ptr = NULL;
 
 // =================================================================================
 // --- FUNÇÕES DE HARDWARE E DESENHO ---
 // =================================================================================
 void cleanup_resources() {
-    if (tela) munmap((void*)tela, LWIDTH * VISIBLE_HEIGHT * PIXEL_SIZE);
-    if (peripheral_map) munmap((void*)peripheral_map, PERIPHERAL_SIZE);
-    if (mem_fd != -1) close(mem_fd);
+    hw_close();
     printf("\nRecursos liberados. Saindo do jogo.\n");
 }
 
 int init_hardware() {
-    mem_fd = open("/dev/mem", O_RDWR | O_SYNC);
-    if (mem_fd == -1) { perror("Erro ao abrir /dev/mem"); return -1; }
-    
-    void* vga_map = mmap(NULL, LWIDTH * VISIBLE_HEIGHT * PIXEL_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, FRAME_BASE);
-    if (vga_map == MAP_FAILED) { perror("Erro ao mapear VGA"); close(mem_fd); return -1; }
-    tela = (volatile uint16_t (*)[LWIDTH])vga_map;
-
-    peripheral_map = mmap(NULL, PERIPHERAL_SIZE, PROT_READ, MAP_SHARED, mem_fd, PERIPHERAL_BASE);
-    if (peripheral_map == MAP_FAILED) { perror("Erro ao mapear periféricos"); munmap(vga_map, LWIDTH * VISIBLE_HEIGHT * PIXEL_SIZE); close(mem_fd); return -1; }
-    
-    key_ptr = (volatile unsigned int *)(peripheral_map + DEVICES_BUTTONS);
+    if (hw_init() != 0) return -1;
+    tela = hw_framebuffer();
+    key_ptr = hw_reg(KEY_OFFSET);
 
     atexit(cleanup_resources);
     return 0;
@@ -0,0 +1,158 @@
+#ifndef FRAME_DIFF_H
+#define FRAME_DIFF_H
+
+#include <stdint.h>
+#include <string.h>
+#include "blit.h"
+#include "indexed.h"
+
+// =================================================================================
+// --- APRESENTAÇÃO POR DIFERENÇA ENTRE QUADROS ---
+// =================================================================================
+// Guarda uma cópia (em memória comum) do último quadro apresentado e, a cada
+// quadro, compara linha por linha com o novo: linhas iguais (um memcmp() no
+// cache) não são tocadas; nas diferentes, a comparação é feita em blocos de 8
+// bytes e só os trechos alterados são escritos na tela. Trechos separados por
+// menos de FRAME_DIFF_GAP blocos iguais viram um só, para não quebrar as
+// escritas de 64 bits em rajadas muito curtas.
+//
+// Ler e comparar memória com cache custa bem menos que escrever no
+// framebuffer O_SYNC, onde cada escrita é uma transação no barramento; no
+// pior caso (tudo mudou) o custo extra é uma leitura do quadro.
+//
+// O que for desenhado direto na tela, fora do quadro (sprites, placar), deve
+// ser declarado com frame_diff_damage(): o retângulo é reescrito a partir do
+// quadro no próximo present, mesmo que o quadro não tenha mudado ali.
+//
+// Funciona com quadros RGB565 (bpp = 2) ou indexados (bpp = 1, com paleta).
+// Ao mudar a paleta, chamar frame_diff_invalidate(): os índices são os mesmos,
+// mas as cores na tela não.
+//
+// Uso: frame_diff_init(&d, copia, largura, altura, bpp) com 'copia' de
+// largura * altura * bpp bytes; a cada quadro frame_diff_present() e
+// d.rows_written / d.pixels_written / d.stores_written para ver quanto foi escrito.
+#define FRAME_DIFF_MAX_ROWS 240
+#define FRAME_DIFF_GAP      2   // Blocos iguais (8 bytes) que ainda não separam trechos
+
+typedef struct {
+    uint8_t *last;              // Último quadro apresentado, no formato da origem
+    int width, height, bpp;     // bpp: bytes por pixel (1 = indexado, 2 = RGB565)
+    int valid;                  // 0 = o próximo present escreve tudo
+    int16_t damage_x0[FRAME_DIFF_MAX_ROWS];   // Colunas a reescrever por linha
+    int16_t damage_x1[FRAME_DIFF_MAX_ROWS];   // (x0 >= x1 = nada)
+    unsigned int rows_written;  // Linhas com alguma escrita no último present
+    unsigned long pixels_written;
+    unsigned long stores_written; // Escritas no framebuffer (16 ou 64 bits) no último present
+} FrameDiff;
+
+static inline void frame_diff_invalidate(FrameDiff *d) {
+    d->valid = 0;
+}
+
+static inline int frame_diff_init(FrameDiff *d, void *last, int width, int height, int bpp) {
+    if (height > FRAME_DIFF_MAX_ROWS || (bpp != 1 && bpp != 2)) return -1;
+    d->last = (uint8_t *)last;
+    d->width = width;
+    d->height = height;
+    d->bpp = bpp;
+    d->rows_written = 0;
+    d->pixels_written = 0;
+    d->stores_written = 0;
+    for (int y = 0; y < height; y++) {
+        d->damage_x0[y] = (int16_t)width;
+        d->damage_x1[y] = 0;
+    }
+    frame_diff_invalidate(d);
+    return 0;
+}
+
+// Marca [x0, x1) x [y0, y1) da tela como sobrescrito fora do quadro
+static inline void frame_diff_damage(FrameDiff *d, int x0, int y0, int x1, int y1) {
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > d->width) x1 = d->width;
+    if (y1 > d->height) y1 = d->height;
+    if (x0 >= x1) return;
+    for (int y = y0; y < y1; y++) {
+        if (x0 < d->damage_x0[y]) d->damage_x0[y] = (int16_t)x0;
+        if (x1 > d->damage_x1[y]) d->damage_x1[y] = (int16_t)x1;
+    }
+}
+
+// Escreve os bytes [start, end) da linha 'y' na tela (a cópia é atualizada por linha)
+static inline void frame_diff_flush(FrameDiff *d, int y, const uint8_t *row, int start, int end, const Palette *palette,
+                                    volatile uint16_t *device, int device_stride) {
+    int x = start / d->bpp, n = (end - start) / d->bpp;
+    volatile uint16_t *dst = device + (long)y * device_stride + x;
+    if (palette != NULL) indexed_store_row(dst, row + start, n, palette->color);
+    else blit_store_row(dst, (const uint16_t *)(row + start), n);
+    d->pixels_written += n;
+    d->stores_written += blit_store_count(dst, n);
+}
+
+/**
+ * @brief Apresenta o quadro escrevendo só o que mudou desde o último present.
+ * @param pixels Quadro (width x height, 'stride' bytes por linha), em memória comum.
+ * @param palette Paleta para quadros indexados; NULL para RGB565.
+ * @return Linhas escritas (também em d->rows_written).
+ */
+static inline unsigned int frame_diff_present(FrameDiff *d, const void *pixels, int stride, const Palette *palette,
+                                              volatile uint16_t *device, int device_stride) {
+    const int bytes = d->width * d->bpp;
+    d->rows_written = 0;
+    d->pixels_written = 0;
+    d->stores_written = 0;
+    for (int y = 0; y < d->height; y++) {
+        const uint8_t *row = (const uint8_t *)pixels + (long)y * stride;
+        const uint8_t *last = d->last + (long)y * bytes;
+        int damage_start = d->damage_x0[y] * d->bpp, damage_end = d->damage_x1[y] * d->bpp;
+        d->damage_x0[y] = (int16_t)d->width;
+        d->damage_x1[y] = 0;
+        if (d->valid && damage_start >= damage_end && memcmp(row, last, bytes) == 0) continue;
+
+        d->rows_written++;
+        if (!d->valid) {
+            frame_diff_flush(d, y, row, 0, bytes, palette, device, device_stride);
+            memcpy(d->last + (long)y * bytes, row, bytes);
+            continue;
+        }
+        int run_start = -1, run_end = 0;
+        for (int off = 0; off < bytes; off += 8) {
+            // Atalho: 32 bytes iguais e fora do dano de uma vez (fecham qualquer trecho aberto)
+            if (off + 32 <= bytes && (off >= damage_end || off + 32 <= damage_start)) {
+                uint64_t a[4], b[4];
+                memcpy(a, row + off, 32);
+                memcpy(b, last + off, 32);
+                if (((a[0] ^ b[0]) | (a[1] ^ b[1]) | (a[2] ^ b[2]) | (a[3] ^ b[3])) == 0) {
+                    if (run_start >= 0) frame_diff_flush(d, y, row, run_start, run_end, palette, device, device_stride);
+                    run_start = -1;
+                    off += 24;
+                    continue;
+                }
+            }
+            int n = bytes - off < 8 ? bytes - off : 8, changed;
+            if (n == 8) {
+                uint64_t a, b;
+                memcpy(&a, row + off, 8);
+                memcpy(&b, last + off, 8);
+                changed = a != b;
+            } else {
+                changed = memcmp(row + off, last + off, n) != 0;
+            }
+            changed |= off < damage_end && off + n > damage_start;
+            if (changed) {
+                if (run_start < 0) run_start = off;
+                run_end = off + n;
+            } else if (run_start >= 0 && off + n - run_end >= FRAME_DIFF_GAP * 8) {
+                frame_diff_flush(d, y, row, run_start, run_end, palette, device, device_stride);
+                run_start = -1;
+            }
+        }
+        if (run_start >= 0) frame_diff_flush(d, y, row, run_start, run_end, palette, device, device_stride);
+        memcpy(d->last + (long)y * bytes, row, bytes);
+    }
+    d->valid = 1;
+    return d->rows_written;
+}
+
+#endif
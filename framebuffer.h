@@ -0,0 +1,121 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// =================================================================================
+// --- FRAMEBUFFER COM BUFFER DE PREPARAÇÃO EM CACHE ---
+// =================================================================================
+// O pixel buffer da VGA fica na memória on-chip da FPGA. Como não é RAM do
+// sistema, o kernel ARM o mapeia pelo /dev/mem como memória sem cache
+// (strongly-ordered) com ou sem O_SYNC: cada escrita de 16 bits vira uma
+// transação separada na ponte HPS-FPGA.
+//
+// No modo "staged" (opcional) o programa desenha num buffer comum, com cache,
+// e fb_present() copia as linhas para o framebuffer com escritas de 64 bits,
+// quatro pixels por transação. A cópia é a "limpeza" explícita: nada chega à
+// tela antes dela. fb_verify() relê o framebuffer e confere com o buffer.
+//
+// No modo direto (padrão) fb->pixels aponta para o próprio framebuffer e
+// fb_present() não faz nada, então o mesmo código de desenho serve aos dois.
+//
+// Uso: fb_open() com o framebuffer de hw_framebuffer() (hardware.h), desenhar
+// em fb->pixels[y][x], fb_present() a cada quadro (ou fb_present_rows() só com
+// as linhas alteradas) e fb_close().
+
+#define FB_LWIDTH       512
+#define FB_WIDTH        320
+#define FB_HEIGHT       240
+#define FB_BYTES        (FB_LWIDTH * FB_HEIGHT * 2)
+#define FB_WORDS_PER_ROW (FB_WIDTH * 2 / 8) // Palavras de 64 bits por linha visível
+
+typedef struct {
+    volatile uint16_t (*pixels)[FB_LWIDTH];  // Onde o programa desenha
+    volatile uint16_t (*device)[FB_LWIDTH];  // Framebuffer de verdade (ou em memória)
+    uint16_t (*staging)[FB_LWIDTH];          // NULL no modo direto
+    int offscreen;                           // 1 = device é memória comum (sem a placa)
+} Framebuffer;
+
+// Modo pedido pela variável VGA_FB_MODE ("staged" ou "direct"); direto por padrão
+static inline int fb_env_staged() {
+    const char *mode = getenv("VGA_FB_MODE");
+    return mode != NULL && strcmp(mode, "staged") == 0;
+}
+
+/**
+ * @brief Prepara o framebuffer. Com device == NULL usa um framebuffer em memória.
+ * @param device Framebuffer já mapeado (hw_framebuffer()); continua do chamador.
+ * @param staged 1 para desenhar num buffer em cache e copiar em fb_present().
+ * @return 0 em sucesso, -1 em erro.
+ */
+static inline int fb_open(Framebuffer *fb, volatile void *device, int staged) {
+    memset(fb, 0, sizeof(*fb));
+    if (device == NULL) {
+        device = calloc(1, FB_BYTES);
+        if (device == NULL) return -1;
+        fb->offscreen = 1;
+    }
+    fb->device = (volatile uint16_t (*)[FB_LWIDTH])device;
+    fb->pixels = fb->device;
+
+    if (staged) {
+        void *buffer = NULL;
+        if (posix_memalign(&buffer, 64, FB_BYTES) != 0) {
+            if (fb->offscreen) free((void *)device);
+            return -1;
+        }
+        fb->staging = (uint16_t (*)[FB_LWIDTH])buffer;
+        // Parte do conteúdo atual da tela, para que fb_present() não o apague
+        for (int y = 0; y < FB_HEIGHT; y++) {
+            for (int x = 0; x < FB_WIDTH; x++) fb->staging[y][x] = fb->device[y][x];
+        }
+        fb->pixels = fb->staging;
+    }
+    return 0;
+}
+
+static inline void fb_close(Framebuffer *fb) {
+    if (fb->device == NULL) return;
+    free(fb->staging);
+    if (fb->offscreen) free((void *)fb->device);
+    fb->device = NULL;
+    fb->staging = NULL;
+    fb->pixels = NULL;
+}
+
+// Copia as linhas [y0, y1) do buffer para o framebuffer com escritas de 64 bits
+static inline void fb_present_rows(Framebuffer *fb, int y0, int y1) {
+    if (fb->staging == NULL) return;
+    if (y0 < 0) y0 = 0;
+    if (y1 > FB_HEIGHT) y1 = FB_HEIGHT;
+    for (int y = y0; y < y1; y++) {
+        const uint16_t *src = fb->staging[y];
+        volatile uint64_t *dst = (volatile uint64_t *)fb->device[y];
+        for (int i = 0; i < FB_WORDS_PER_ROW; i++) {
+            uint64_t word;
+            memcpy(&word, src + 4 * i, sizeof(word)); // Uma leitura de 64 bits do cache
+            dst[i] = word;
+        }
+    }
+}
+
+static inline void fb_present(Framebuffer *fb) {
+    fb_present_rows(fb, 0, FB_HEIGHT);
+}
+
+// Relê o framebuffer e conta os pixels diferentes do que foi desenhado
+static inline long fb_verify(Framebuffer *fb) {
+    if (fb->staging == NULL) return 0;
+    long mismatches = 0;
+    for (int y = 0; y < FB_HEIGHT; y++) {
+        for (int x = 0; x < FB_WIDTH; x++) {
+            if (fb->device[y][x] != fb->staging[y][x]) mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef HARDWARE_H
+#define HARDWARE_H
+
+#include <stdint.h>
+
+// =================================================================================
+// --- ACESSO AO HARDWARE DA DE1-SoC ---
+// =================================================================================
+// Um único módulo para os registradores dos periféricos (janela de 64 KB em
+// 0xFF200000), o framebuffer da VGA e o buffer de caracteres (80x60, um byte
+// ASCII por posição, linhas de 128 bytes, sobreposto à imagem pela própria
+// VGA). O backend é escolhido na compilação:
+//
+//   (padrão)        Linux: hw_init() mapeia as três regiões pelo /dev/mem uma
+//                   vez por processo; as chamadas seguintes não fazem nada.
+//   -DHW_BAREMETAL  Sem sistema operacional (CPUlator, programas .elf): os
+//                   endereços físicos são constantes e hw_init() é vazio.
+//   -DHW_SIM        Simulado: as três regiões são memória comum, para rodar
+//                   e medir os programas fora da placa.
+//
+// Os acessores são static inline sobre um endereço base; no bare metal o
+// endereço é constante e hw_read()/hw_write() viram uma única instrução.
+//
+// Uso: #include "hardware.h", hw_init() no início, hw_read(SW_OFFSET),
+// hw_write(LEDR_OFFSET, valor), hw_reg() para módulos que recebem ponteiros
+// hw_framebuffer() para a tela e hw_charbuffer() para o texto (text_overlay.h).
+// hw_close() ao sair.
+
+#define HW_REGS_BASE      0xFF200000
+#define HW_REGS_SPAN      0x00010000 // Cobre todos os offsets abaixo
+#define HW_FRAME_BASE     0xC8000000
+#define HW_LWIDTH         512        // Stride do framebuffer, em pixels
+#define HW_FRAME_HEIGHT   240
+#define HW_FRAME_SPAN     (HW_LWIDTH * HW_FRAME_HEIGHT * 2)
+#define HW_CHAR_BASE      0xC9000000
+#define HW_CHAR_COLS      80
+#define HW_CHAR_ROWS      60
+#define HW_CHAR_STRIDE    128        // Bytes entre o início de duas linhas de texto
+#define HW_CHAR_SPAN      (HW_CHAR_STRIDE * HW_CHAR_ROWS)
+
+// Offsets dos periféricos dentro da janela
+#define LEDR_OFFSET       0x0000     // LEDR9-LEDR0
+#define HEX3_0_OFFSET     0x0020     // Displays HEX3-HEX0
+#define HEX5_4_OFFSET     0x0030     // Displays HEX5-HEX4
+#define SW_OFFSET         0x0040     // Chaves SW9-SW0
+#define KEY_OFFSET        0x0050     // Botões KEY3-KEY0
+#define JTAG_UART_OFFSET  0x1000     // JTAG UART (dados; controle em +4)
+#define PIXEL_CTRL_OFFSET 0x3020     // Controlador do pixel buffer da VGA
+
+typedef volatile uint16_t HwFrameRow[HW_LWIDTH];
+
+#if defined(HW_BAREMETAL)
+
+#define HW_BACKEND_NAME "bare metal"
+#define hw_regs      ((volatile uint8_t *)HW_REGS_BASE)
+#define hw_frame_map ((HwFrameRow *)HW_FRAME_BASE)
+#define hw_char_map  ((volatile uint8_t *)HW_CHAR_BASE)
+
+static inline int hw_init() { return 0; }
+static inline void hw_close() {}
+
+#else
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+static volatile uint8_t *hw_regs = NULL;
+static HwFrameRow *hw_frame_map = NULL;
+static volatile uint8_t *hw_char_map = NULL;
+
+#if defined(HW_SIM)
+
+#define HW_BACKEND_NAME "simulado"
+
+static inline void hw_close() {
+    free((void *)hw_regs);
+    free((void *)hw_frame_map);
+    free((void *)hw_char_map);
+    hw_regs = NULL;
+    hw_frame_map = NULL;
+    hw_char_map = NULL;
+}
+
+static inline int hw_init() {
+    if (hw_regs != NULL) return 0;
+    hw_regs = (volatile uint8_t *)calloc(1, HW_REGS_SPAN);
+    hw_frame_map = (HwFrameRow *)calloc(1, HW_FRAME_SPAN);
+    hw_char_map = (volatile uint8_t *)calloc(1, HW_CHAR_SPAN);
+    if (hw_regs == NULL || hw_frame_map == NULL || hw_char_map == NULL) {
+        hw_close(); // Sem sobras: a próxima chamada tenta de novo do zero
+        return -1;
+    }
+    return 0;
+}
+
+#else
+
+#define HW_BACKEND_NAME "/dev/mem"
+
+static int hw_mem_fd = -1;
+
+/**
+ * @brief Mapeia periféricos, framebuffer e texto (apenas na primeira chamada).
+ * @return 0 em sucesso, -1 em erro.
+ */
+static inline int hw_init() {
+    if (hw_regs != NULL) return 0;
+
+    hw_mem_fd = open("/dev/mem", O_RDWR | O_SYNC);
+    if (hw_mem_fd == -1) {
+        perror("Erro ao abrir /dev/mem");
+        return -1;
+    }
+
+    void *regs = mmap(NULL, HW_REGS_SPAN, PROT_READ | PROT_WRITE, MAP_SHARED, hw_mem_fd, HW_REGS_BASE);
+    if (regs == MAP_FAILED) {
+        perror("Erro ao mapear os perifericos");
+        close(hw_mem_fd);
+        hw_mem_fd = -1;
+        return -1;
+    }
+
+    void *frame = mmap(NULL, HW_FRAME_SPAN, PROT_READ | PROT_WRITE, MAP_SHARED, hw_mem_fd, HW_FRAME_BASE);
+    if (frame == MAP_FAILED) {
+        perror("Erro ao mapear o framebuffer da VGA");
+        munmap(regs, HW_REGS_SPAN);
+        close(hw_mem_fd);
+        hw_mem_fd = -1;
+        return -1;
+    }
+
+    // Só o texto depende do buffer de caracteres: sem ele, hw_charbuffer()
+    // devolve NULL e text_overlay.h não faz nada
+    void *chars = mmap(NULL, HW_CHAR_SPAN, PROT_READ | PROT_WRITE, MAP_SHARED, hw_mem_fd, HW_CHAR_BASE);
+    if (chars == MAP_FAILED) {
+        perror("Aviso: buffer de caracteres indisponivel");
+        chars = NULL;
+    }
+
+    hw_regs = (volatile uint8_t *)regs;
+    hw_frame_map = (HwFrameRow *)frame;
+    hw_char_map = (volatile uint8_t *)chars;
+    return 0;
+}
+
+static inline void hw_close() {
+    if (hw_regs != NULL) munmap((void *)hw_regs, HW_REGS_SPAN);
+    if (hw_frame_map != NULL) munmap((void *)hw_frame_map, HW_FRAME_SPAN);
+    if (hw_char_map != NULL) munmap((void *)hw_char_map, HW_CHAR_SPAN);
+    if (hw_mem_fd != -1) close(hw_mem_fd);
+    hw_regs = NULL;
+    hw_frame_map = NULL;
+    hw_char_map = NULL;
+    hw_mem_fd = -1;
+}
+
+#endif // HW_SIM
+#endif // HW_BAREMETAL
+
+// Ponteiro para o registrador, para módulos que guardam o endereço (key_input.h)
+static inline volatile unsigned int *hw_reg(unsigned int offset) {
+    return (volatile unsigned int *)(hw_regs + offset);
+}
+
+static inline unsigned int hw_read(unsigned int offset) {
+    return *hw_reg(offset);
+}
+
+static inline void hw_write(unsigned int offset, unsigned int value) {
+    *hw_reg(offset) = value;
+}
+
+// Framebuffer como matriz [linha][coluna] com stride HW_LWIDTH
+static inline HwFrameRow *hw_framebuffer() {
+    return hw_frame_map;
+}
+
+// Buffer de caracteres: posição (coluna, linha) em [linha * HW_CHAR_STRIDE + coluna].
+// NULL se não pôde ser mapeado (o resto do hardware continua disponível)
+static inline volatile uint8_t *hw_charbuffer() {
+    return hw_char_map;
+}
+
+#endif
@@ -0,0 +1,201 @@
+#ifndef HEX_DISPLAY_H
+#define HEX_DISPLAY_H
+
+#include <stdint.h>
+#include <string.h>
+
+// =================================================================================
+// --- DISPLAYS DE 7 SEGMENTOS (HEX5-HEX0) ---
+// =================================================================================
+// Os seis displays ficam em dois registradores: HEX3_0 (HEX0 nos bits 6:0,
+// HEX1 em 14:8, HEX2 em 22:16, HEX3 em 30:24) e HEX5_4 (HEX4 em 6:0, HEX5 em
+// 14:8). Segmentos: bit 0 = a (topo), 1 = b, 2 = c, 3 = d, 4 = e, 5 = f,
+// 6 = g (meio).
+//
+// O módulo guarda uma cópia (sombra) do último valor de cada registrador e
+// só escreve quando o novo valor é diferente, no máximo uma escrita por
+// registrador em cada atualização: sem apagar-e-reescrever, não há cintilação.
+// Números e textos viram palavras de 32 bits já empacotadas a partir de
+// tabelas pré-calculadas (pares de dígitos decimais e caracteres ASCII).
+//
+// Uso: hex_init(&hex, hw_reg(HEX3_0_OFFSET), hw_reg(HEX5_4_OFFSET)) e depois
+// hex_show_number(), hex_show_text(), hex_show_codes() ou um HexMarquee.
+
+#define HEX_DIGITS 6
+
+typedef struct {
+    volatile unsigned int *reg3_0;
+    volatile unsigned int *reg5_4;
+    uint32_t shadow3_0;
+    uint32_t shadow5_4;
+    int shadow_valid;           // 0 = a próxima atualização escreve os dois
+    unsigned long writes;       // Escritas feitas nos registradores
+} HexDisplay;
+
+// Dígitos hexadecimais 0-F
+static const uint8_t hex_digit_codes[16] = {
+    0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07,
+    0x7F, 0x6F, 0x77, 0x7C, 0x39, 0x5E, 0x79, 0x71
+};
+
+// Caracteres ASCII aproximados nos 7 segmentos (0 = apagado)
+static const uint8_t hex_char_codes[128] = {
+    ['0'] = 0x3F, ['1'] = 0x06, ['2'] = 0x5B, ['3'] = 0x4F, ['4'] = 0x66,
+    ['5'] = 0x6D, ['6'] = 0x7D, ['7'] = 0x07, ['8'] = 0x7F, ['9'] = 0x6F,
+    ['A'] = 0x77, ['B'] = 0x7C, ['C'] = 0x39, ['D'] = 0x5E, ['E'] = 0x79,
+    ['F'] = 0x71, ['G'] = 0x3D, ['H'] = 0x76, ['I'] = 0x30, ['J'] = 0x1E,
+    ['K'] = 0x75, ['L'] = 0x38, ['M'] = 0x37, ['N'] = 0x54, ['O'] = 0x3F,
+    ['P'] = 0x73, ['Q'] = 0x67, ['R'] = 0x50, ['S'] = 0x6D, ['T'] = 0x78,
+    ['U'] = 0x3E, ['V'] = 0x3E, ['W'] = 0x2A, ['X'] = 0x76, ['Y'] = 0x6E,
+    ['Z'] = 0x5B,
+    ['a'] = 0x77, ['b'] = 0x7C, ['c'] = 0x58, ['d'] = 0x5E, ['e'] = 0x79,
+    ['f'] = 0x71, ['g'] = 0x3D, ['h'] = 0x74, ['i'] = 0x10, ['j'] = 0x1E,
+    ['k'] = 0x75, ['l'] = 0x38, ['m'] = 0x37, ['n'] = 0x54, ['o'] = 0x5C,
+    ['p'] = 0x73, ['q'] = 0x67, ['r'] = 0x50, ['s'] = 0x6D, ['t'] = 0x78,
+    ['u'] = 0x1C, ['v'] = 0x1C, ['w'] = 0x2A, ['x'] = 0x76, ['y'] = 0x6E,
+    ['z'] = 0x5B,
+    ['-'] = 0x40, ['_'] = 0x08, ['='] = 0x48, ['\''] = 0x20, ['"'] = 0x22,
+    ['['] = 0x39, [']'] = 0x0F, ['?'] = 0x53, ['.'] = 0x08
+};
+
+// Pares decimais 00-99 já empacotados (dezena nos bits 14:8, unidade em 6:0)
+static uint16_t hex_pair_codes[100];
+static int hex_tables_ready = 0;
+
+// Máscaras para apagar zeros à esquerda, indexadas pelo número de dígitos visíveis
+static const uint32_t hex_keep3_0[HEX_DIGITS + 1] = {
+    0x00000000, 0x0000007F, 0x00007F7F, 0x007F7F7F, 0x7F7F7F7F, 0x7F7F7F7F, 0x7F7F7F7F
+};
+static const uint32_t hex_keep5_4[HEX_DIGITS + 1] = {
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x007F, 0x7F7F
+};
+
+static inline void hex_build_tables() {
+    for (int i = 0; i < 100; i++) {
+        hex_pair_codes[i] = (uint16_t)((hex_digit_codes[i / 10] << 8) | hex_digit_codes[i % 10]);
+    }
+    hex_tables_ready = 1;
+}
+
+static inline void hex_init(HexDisplay *hd, volatile unsigned int *reg3_0, volatile unsigned int *reg5_4) {
+    hd->reg3_0 = reg3_0;
+    hd->reg5_4 = reg5_4;
+    hd->shadow3_0 = 0;
+    hd->shadow5_4 = 0;
+    hd->shadow_valid = 0;
+    hd->writes = 0;
+    if (!hex_tables_ready) hex_build_tables();
+}
+
+/**
+ * @brief Atualiza os dois registradores com palavras já empacotadas.
+ * Cada um é escrito no máximo uma vez, e só se o valor mudou.
+ */
+static inline void hex_commit(HexDisplay *hd, uint32_t word3_0, uint32_t word5_4) {
+    if (!hd->shadow_valid || word3_0 != hd->shadow3_0) {
+        *hd->reg3_0 = word3_0;
+        hd->shadow3_0 = word3_0;
+        hd->writes++;
+    }
+    if (!hd->shadow_valid || word5_4 != hd->shadow5_4) {
+        *hd->reg5_4 = word5_4;
+        hd->shadow5_4 = word5_4;
+        hd->writes++;
+    }
+    hd->shadow_valid = 1;
+}
+
+// Segmentos de cada display; codes[0] = HEX0 ... codes[5] = HEX5
+static inline void hex_show_codes(HexDisplay *hd, const uint8_t codes[HEX_DIGITS]) {
+    uint32_t word3_0 = codes[0] | (codes[1] << 8) | (codes[2] << 16) | ((uint32_t)codes[3] << 24);
+    uint32_t word5_4 = codes[4] | (codes[5] << 8);
+    hex_commit(hd, word3_0, word5_4);
+}
+
+/**
+ * @brief Empacota um número decimal (0-999999) alinhado à direita, sem escrever.
+ * @param min_digits Dígitos sempre visíveis (zeros à esquerda); os demais zeros
+ * à esquerda ficam apagados.
+ */
+static inline void hex_pack_number(unsigned int value, int min_digits, uint32_t *word3_0, uint32_t *word5_4) {
+    if (value > 999999) value = 999999;
+    int digits = 1;
+    for (unsigned int v = value; v >= 10; v /= 10) digits++;
+    if (digits < min_digits) digits = min_digits > HEX_DIGITS ? HEX_DIGITS : min_digits;
+
+    *word3_0 = (hex_pair_codes[value % 100] | ((uint32_t)hex_pair_codes[(value / 100) % 100] << 16)) & hex_keep3_0[digits];
+    *word5_4 = hex_pair_codes[value / 10000] & hex_keep5_4[digits];
+}
+
+static inline void hex_show_number(HexDisplay *hd, unsigned int value, int min_digits) {
+    uint32_t word3_0, word5_4;
+    hex_pack_number(value, min_digits, &word3_0, &word5_4);
+    hex_commit(hd, word3_0, word5_4);
+}
+
+// Mostra até 6 caracteres da esquerda (HEX5) para a direita (HEX0)
+static inline void hex_show_text(HexDisplay *hd, const char *text) {
+    uint8_t codes[HEX_DIGITS] = {0};
+    for (int i = 0; i < HEX_DIGITS && text[i] != '\0'; i++) {
+        codes[HEX_DIGITS - 1 - i] = hex_char_codes[(unsigned char)text[i] & 0x7F];
+    }
+    hex_show_codes(hd, codes);
+}
+
+static inline void hex_clear(HexDisplay *hd) {
+    hex_commit(hd, 0, 0);
+}
+
+// =================================================================================
+// --- LETREIRO (TEXTO ROLANDO) ---
+// =================================================================================
+// O texto é convertido em segmentos uma única vez, com 6 espaços antes e
+// depois, e cada passo só empacota a janela atual. O avanço segue o relógio
+// (um caractere a cada step_ns), não o número de chamadas, então a rolagem
+// tem ritmo constante mesmo que o laço do programa varie.
+#define HEX_MARQUEE_MAX 128
+
+typedef struct {
+    uint8_t codes[HEX_MARQUEE_MAX + 2 * HEX_DIGITS];
+    int length;                 // Caracteres em codes (com os espaços)
+    int offset;                 // Primeiro caractere da janela (HEX5)
+    uint64_t step_ns;
+    uint64_t next_step_ns;      // 0 = ainda não começou
+} HexMarquee;
+
+static inline void hex_marquee_start(HexMarquee *m, const char *text, unsigned int step_ms) {
+    int len = (int)strlen(text);
+    if (len > HEX_MARQUEE_MAX) len = HEX_MARQUEE_MAX;
+    memset(m->codes, 0, sizeof(m->codes));
+    for (int i = 0; i < len; i++) {
+        m->codes[HEX_DIGITS + i] = hex_char_codes[(unsigned char)text[i] & 0x7F];
+    }
+    m->length = len + 2 * HEX_DIGITS;
+    m->offset = 0;
+    m->step_ns = (uint64_t)step_ms * 1000000ull;
+    m->next_step_ns = 0;
+}
+
+/**
+ * @brief Avança o letreiro se já passou o tempo de um passo e atualiza os displays.
+ * @return 1 se a janela mudou, 0 caso contrário.
+ */
+static inline int hex_marquee_update(HexDisplay *hd, HexMarquee *m, uint64_t now_ns) {
+    if (m->next_step_ns == 0) {
+        m->next_step_ns = now_ns + m->step_ns;
+    } else {
+        if (now_ns < m->next_step_ns) return 0;
+        // Se o laço atrasou, pula os passos perdidos em vez de acelerar depois
+        uint64_t steps = (now_ns - m->next_step_ns) / m->step_ns + 1;
+        m->offset = (int)((m->offset + steps) % (m->length - HEX_DIGITS));
+        m->next_step_ns += steps * m->step_ns;
+    }
+
+    const uint8_t *w = &m->codes[m->offset];
+    uint32_t word5_4 = w[1] | (w[0] << 8);
+    uint32_t word3_0 = w[5] | (w[4] << 8) | (w[3] << 16) | ((uint32_t)w[2] << 24);
+    hex_commit(hd, word3_0, word5_4);
+    return 1;
+}
+
+#endif
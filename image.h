@@ -0,0 +1,181 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "blit.h"
+#include "rgb565.h"
+
+// =================================================================================
+// --- IMAGENS PPM/BMP MAPEADAS EM MEMÓRIA ---
+// =================================================================================
+// O arquivo é mapeado com mmap() e os pixels são lidos direto do mapeamento:
+// não há cópia da imagem inteira em memória. img_draw() converte cada linha
+// visível de RGB888 para RGB565 (rgb565.h) já na posição final da superfície
+// de destino, depois do recorte contra as bordas. Com img.dither = 1 a
+// conversão usa o pontilhado ordenado (rgb565_dither_row), sem faixas.
+//
+// Formatos aceitos:
+//   PPM binário (P6) com valor máximo 255
+//   BMP de 24 bits sem compressão, de baixo para cima ou de cima para baixo
+//
+// Uso: img_open(&img, "logo.ppm"), img_draw(&img, &superficie, x, y, &r),
+// img_close(&img). Para a VGA, desenhar na cópia em cache da tela e mandar o
+// retângulo 'r' com blit_present().
+
+typedef struct {
+    uint8_t *map;               // Arquivo inteiro (mmap)
+    size_t map_size;
+    const uint8_t *first_row;   // Primeira linha da imagem (a de cima)
+    long row_step;              // Bytes de uma linha para a de baixo (< 0 no BMP comum)
+    int width, height;
+    int bgr;                    // 1 = pixels em B,G,R (BMP)
+    int dither;                 // 1 = pontilhado ordenado em img_draw() (0 após img_open)
+    const char *format;
+} Image;
+
+static inline uint32_t img_le32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Próximo número do cabeçalho PPM, pulando espaços e comentários
+static inline long img_ppm_number(const uint8_t *data, size_t size, size_t *pos) {
+    while (*pos < size) {
+        if (data[*pos] == '#') {
+            while (*pos < size && data[*pos] != '\n') (*pos)++;
+        } else if (data[*pos] == ' ' || data[*pos] == '\t' || data[*pos] == '\r' || data[*pos] == '\n') {
+            (*pos)++;
+        } else {
+            break;
+        }
+    }
+    long value = -1;
+    while (*pos < size && data[*pos] >= '0' && data[*pos] <= '9') {
+        value = (value < 0 ? 0 : value * 10) + (data[*pos] - '0');
+        if (value > 1000000) return -1;
+        (*pos)++;
+    }
+    return value;
+}
+
+static inline int img_parse_ppm(Image *img) {
+    size_t pos = 2;
+    long width = img_ppm_number(img->map, img->map_size, &pos);
+    long height = img_ppm_number(img->map, img->map_size, &pos);
+    long maxval = img_ppm_number(img->map, img->map_size, &pos);
+    if (width <= 0 || height <= 0 || maxval != 255) return -1;
+    pos++; // Um único espaço separa o cabeçalho dos pixels
+    // Por divisão: na placa (32 bits) largura * altura * 3 pode dar a volta
+    if (pos > img->map_size || (size_t)height > (img->map_size - pos) / ((size_t)width * 3)) return -1;
+    img->width = (int)width;
+    img->height = (int)height;
+    img->first_row = img->map + pos;
+    img->row_step = width * 3;
+    img->bgr = 0;
+    img->format = "PPM";
+    return 0;
+}
+
+static inline int img_parse_bmp(Image *img) {
+    const uint8_t *h = img->map;
+    if (img->map_size < 54) return -1;
+    uint32_t offset = img_le32(h + 10);
+    int32_t width = (int32_t)img_le32(h + 18);
+    int32_t height = (int32_t)img_le32(h + 22);
+    int bpp = h[28] | (h[29] << 8);
+    uint32_t compression = img_le32(h + 30);
+    if (bpp != 24 || compression != 0 || width <= 0 || height == 0 || width > 1000000 || height < -1000000 || height > 1000000) return -1;
+
+    int top_down = height < 0;
+    if (top_down) height = -height;
+    size_t stride = ((size_t)width * 3 + 3) & ~(size_t)3; // Linhas alinhadas a 4 bytes
+    // Por divisão: na placa (32 bits) stride * altura pode dar a volta
+    if (offset > img->map_size || (size_t)height > (img->map_size - offset) / stride) return -1;
+    img->width = width;
+    img->height = height;
+    // No BMP comum a primeira linha guardada é a de baixo
+    img->first_row = img->map + offset + (top_down ? 0 : stride * (size_t)(height - 1));
+    img->row_step = top_down ? (long)stride : -(long)stride;
+    img->bgr = 1;
+    img->format = "BMP";
+    return 0;
+}
+
+/**
+ * @brief Mapeia e valida um arquivo PPM (P6) ou BMP de 24 bits.
+ * @return 0 em sucesso, -1 em erro (com mensagem).
+ */
+static inline int img_open(Image *img, const char *path) {
+    memset(img, 0, sizeof(*img));
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        perror("Erro ao abrir a imagem");
+        return -1;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < 3) {
+        fprintf(stderr, "Imagem vazia ou ilegivel: %s\n", path);
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // O mapeamento continua válido sem o descritor
+    if (map == MAP_FAILED) {
+        perror("Erro ao mapear a imagem");
+        return -1;
+    }
+    madvise(map, info.st_size, MADV_SEQUENTIAL);
+    img->map = (uint8_t *)map;
+    img->map_size = info.st_size;
+
+    int status = -1;
+    if (img->map[0] == 'P' && img->map[1] == '6') status = img_parse_ppm(img);
+    else if (img->map[0] == 'B' && img->map[1] == 'M') status = img_parse_bmp(img);
+    if (status != 0) {
+        fprintf(stderr, "Formato nao suportado (use PPM P6 ou BMP 24 bits): %s\n", path);
+        munmap(map, info.st_size);
+        img->map = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static inline void img_close(Image *img) {
+    if (img->map != NULL) munmap(img->map, img->map_size);
+    img->map = NULL;
+}
+
+/**
+ * @brief Desenha a imagem com o canto superior esquerdo em (x, y), recortada.
+ * @param dest Recebe o retângulo escrito na superfície (pode ser NULL).
+ * @return Pixels escritos.
+ */
+static inline int img_draw(const Image *img, BlitSurface *surface, int x, int y, BlitRect *dest) {
+    int src_x = 0, src_y = 0, w = img->width, h = img->height;
+    if (x < 0) { src_x = -x; w += x; x = 0; }
+    if (y < 0) { src_y = -y; h += y; y = 0; }
+    if (x + w > surface->width) w = surface->width - x;
+    if (y + h > surface->height) h = surface->height - y;
+    if (w <= 0 || h <= 0) {
+        if (dest != NULL) *dest = (BlitRect){ 0, 0, 0, 0 };
+        return 0;
+    }
+
+    const uint8_t *src = img->first_row + (long)src_y * img->row_step + src_x * 3;
+    uint16_t *dst = surface->pixels + (long)y * surface->stride + x;
+    for (int row = 0; row < h; row++) {
+        if (img->dither) rgb565_dither_row(dst, src, w, img->bgr, x, y + row);
+        else rgb565_row(dst, src, w, img->bgr);
+        src += img->row_step;
+        dst += surface->stride;
+    }
+    if (dest != NULL) *dest = (BlitRect){ x, y, w, h };
+    return w * h;
+}
+
+#endif
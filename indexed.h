@@ -0,0 +1,113 @@
+#ifndef INDEXED_H
+#define INDEXED_H
+
+#include <stdint.h>
+#include <string.h>
+#include "blit.h"
+
+// =================================================================================
+// --- BUFFER INDEXADO (8 BITS) COM PALETA RGB565 ---
+// =================================================================================
+// O quadro é desenhado com índices de 1 byte numa superfície em memória comum
+// (320x240 = 75 KB, metade de um buffer RGB565 e um terço de um com o stride
+// de 512 da VGA) e só vira RGB565 na cópia para a tela: indexed_present()
+// consulta a paleta de 256 cores e escreve quatro pixels por vez, alinhado a
+// 64 bits, como blit_present(). A paleta (512 bytes) fica no cache o tempo todo.
+//
+// Como a cor só é resolvida na apresentação, trocar uma entrada da paleta muda
+// na tela todos os pixels com aquele índice sem redesenhar nenhum: fades,
+// piscadas e ciclos de cor (palette_rotate) custam o mesmo que um quadro parado.
+//
+// Uso: IndexedSurface s = indexed_surface(buffer, stride, largura, altura);
+// desenhar com indexed_fill_rect()/indexed_copy() ou escrevendo nos bytes,
+// ajustar a paleta e chamar indexed_present(&s, &paleta, &tela[0][0], LWIDTH, &r).
+
+typedef struct {
+    uint8_t *pixels;    // Memória comum (com cache)
+    int stride;         // Bytes entre o início de duas linhas
+    int width, height;
+} IndexedSurface;
+
+typedef struct {
+    uint16_t color[256];
+} Palette;
+
+static inline IndexedSurface indexed_surface(void *pixels, int stride, int width, int height) {
+    IndexedSurface s = { (uint8_t *)pixels, stride, width, height };
+    return s;
+}
+
+// Preenche [x0, x1) x [y0, y1), recortado, com o índice 'index'
+static inline void indexed_fill_rect(IndexedSurface *s, int x0, int y0, int x1, int y1, uint8_t index) {
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > s->width) x1 = s->width;
+    if (y1 > s->height) y1 = s->height;
+    if (x0 >= x1) return;
+    for (int y = y0; y < y1; y++) {
+        memset(s->pixels + (long)y * s->stride + x0, index, x1 - x0);
+    }
+}
+
+/**
+ * @brief Copia o retângulo (x, y, w, h) para (to_x, to_y), como blit_copy().
+ * @return Pixels copiados (0 se o recorte não deixou nada).
+ */
+static inline int indexed_copy(IndexedSurface *s, int x, int y, int w, int h, int to_x, int to_y) {
+    BlitSurface bounds = { NULL, s->stride, s->width, s->height }; // Só para o recorte
+    if (!blit_clip(&bounds, &x, &y, &w, &h, &to_x, &to_y)) return 0;
+    uint8_t *src = s->pixels + (long)y * s->stride + x;
+    uint8_t *dst = s->pixels + (long)to_y * s->stride + to_x;
+    if (to_y > y) {
+        for (int row = h - 1; row >= 0; row--) memmove(dst + (long)row * s->stride, src + (long)row * s->stride, w);
+    } else {
+        for (int row = 0; row < h; row++) memmove(dst + (long)row * s->stride, src + (long)row * s->stride, w);
+    }
+    return w * h;
+}
+
+// Entrada da paleta a partir de 0xRRGGBB
+static inline uint16_t palette_rgb(uint32_t rgb) {
+    return (uint16_t)(((rgb >> 8) & 0xF800) | ((rgb >> 5) & 0x07E0) | ((rgb >> 3) & 0x001F));
+}
+
+// Mistura de duas cores RGB565, canal a canal: t = 0 dá 'a', t = 256 dá 'b'
+static inline uint16_t palette_blend(uint16_t a, uint16_t b, int t) {
+    int r = (a >> 11) + (((b >> 11) - (a >> 11)) * t >> 8);
+    int g = ((a >> 5) & 0x3F) + ((((b >> 5) & 0x3F) - ((a >> 5) & 0x3F)) * t >> 8);
+    int bl = (a & 0x1F) + (((b & 0x1F) - (a & 0x1F)) * t >> 8);
+    return (uint16_t)((r << 11) | (g << 5) | bl);
+}
+
+// Gira as entradas [first, first + count) uma posição (ciclo de cores)
+static inline void palette_rotate(Palette *p, int first, int count) {
+    if (count < 2) return;
+    uint16_t last = p->color[first + count - 1];
+    memmove(&p->color[first + 1], &p->color[first], (count - 1) * sizeof(uint16_t));
+    p->color[first] = last;
+}
+
+// Expande n índices pela paleta direto no framebuffer (só escritas)
+static inline void indexed_store_row(volatile uint16_t *dst, const uint8_t *src, int n, const uint16_t *color) {
+    while (n > 0 && ((uintptr_t)dst & 7) != 0) {
+        *dst++ = color[*src++];
+        n--;
+    }
+    volatile uint64_t *dst64 = (volatile uint64_t *)dst;
+    for (; n >= 4; n -= 4, src += 4) {
+        *dst64++ = (uint64_t)color[src[0]] | ((uint64_t)color[src[1]] << 16) |
+                   ((uint64_t)color[src[2]] << 32) | ((uint64_t)color[src[3]] << 48);
+    }
+    dst = (volatile uint16_t *)dst64;
+    while (n-- > 0) *dst++ = color[*src++];
+}
+
+// Copia o retângulo 'r' da superfície para a mesma posição no framebuffer
+static inline void indexed_present(const IndexedSurface *s, const Palette *p, volatile uint16_t *device,
+                                   int device_stride, const BlitRect *r) {
+    for (int row = r->y; row < r->y + r->h; row++) {
+        indexed_store_row(device + (long)row * device_stride + r->x, s->pixels + (long)row * s->stride + r->x, r->w, p->color);
+    }
+}
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef JTAG_UART_H
+#define JTAG_UART_H
+
+#include <stdio.h>
+#include <stdarg.h>
+#include "hardware.h"
+
+// =================================================================================
+// --- JTAG UART (BARE METAL) ---
+// =================================================================================
+// Registrador de dados: bits 7:0 = caractere, bit 15 = RVALID (dado válido),
+// bits 31:16 = RAVAIL (quantos caracteres ainda restam na FIFO de recepção).
+//
+// Registrador de controle (base + 4): bits 31:16 = WSPACE (espaço livre na
+// FIFO de transmissão).
+//
+// A recepção esvazia a FIFO em rajadas: uma leitura com RVALID informa em
+// RAVAIL quantas leituras seguintes também terão dado, então todos os bytes
+// disponíveis vão para um buffer circular de uma vez, sem leituras vazias.
+//
+// A transmissão acumula os bytes num buffer circular e os escreve direto no
+// registrador de dados em rajadas do tamanho de WSPACE, em vez de um
+// putchar + fflush bloqueante por caractere. O buffer é esvaziado por
+// completo a cada '\n' (ou com uart_flush()).
+//
+// Uso: #include "jtag_uart.h" e chamar uart_read() ou uart_line_poll() para
+// ler, e uart_putc(), uart_puts() ou uart_printf() para escrever. Os
+// programas bare metal definem HW_BAREMETAL antes dos includes.
+
+#ifndef IO_JTAG_UART // Pode ser redefinido para simular a UART fora da placa
+#define IO_JTAG_UART        (*hw_reg(JTAG_UART_OFFSET))
+#endif
+#ifndef IO_JTAG_UART_CONTROL
+#define IO_JTAG_UART_CONTROL (*hw_reg(JTAG_UART_OFFSET + 4))
+#endif
+#define UART_RVALID         0x8000
+#define UART_RAVAIL_SHIFT   16
+#define UART_WSPACE_SHIFT   16
+
+#define UART_RX_BUFFER_SIZE 1024 // Potência de 2
+#define UART_TX_BUFFER_SIZE 1024 // Potência de 2
+#define UART_LINE_MAX       256
+
+static unsigned char uart_rx_buffer[UART_RX_BUFFER_SIZE];
+static unsigned int uart_rx_head = 0; // Próxima posição de escrita
+static unsigned int uart_rx_tail = 0; // Próxima posição de leitura
+
+static unsigned char uart_tx_buffer[UART_TX_BUFFER_SIZE];
+static unsigned int uart_tx_head = 0;
+static unsigned int uart_tx_tail = 0;
+
+static inline unsigned int uart_rx_count() {
+    return uart_rx_head - uart_rx_tail;
+}
+
+/**
+ * @brief Transfere para o buffer todos os bytes que a FIFO tiver agora.
+ * @return Quantidade de bytes recebidos (0 se a FIFO estava vazia).
+ */
+static inline int uart_poll_rx() {
+    int received = 0;
+    unsigned int remaining = 1;
+    while (remaining > 0 && uart_rx_count() < UART_RX_BUFFER_SIZE) {
+        unsigned int data = IO_JTAG_UART;
+        if ((data & UART_RVALID) == 0) break;
+        uart_rx_buffer[uart_rx_head++ & (UART_RX_BUFFER_SIZE - 1)] = data & 0xFF;
+        received++;
+        remaining = data >> UART_RAVAIL_SHIFT;
+    }
+    return received;
+}
+
+// Retira um byte do buffer, buscando uma nova rajada na FIFO só quando ele esvazia
+static inline int uart_rx_pop(char *c) {
+    if (uart_rx_count() == 0 && uart_poll_rx() == 0) return 0;
+    *c = uart_rx_buffer[uart_rx_tail++ & (UART_RX_BUFFER_SIZE - 1)];
+    return 1;
+}
+
+// Consulta o próximo byte sem retirá-lo do buffer
+static inline int uart_rx_peek(char *c) {
+    if (uart_rx_count() == 0 && uart_poll_rx() == 0) return 0;
+    *c = uart_rx_buffer[uart_rx_tail & (UART_RX_BUFFER_SIZE - 1)];
+    return 1;
+}
+
+/**
+ * @brief Leitura não bloqueante.
+ * @return Quantidade de bytes copiados para 'buf' (0 se nada disponível).
+ */
+static inline int uart_read(char *buf, int max_len) {
+    uart_poll_rx();
+    int n = 0;
+    while (n < max_len && uart_rx_count() > 0) {
+        buf[n++] = uart_rx_buffer[uart_rx_tail++ & (UART_RX_BUFFER_SIZE - 1)];
+    }
+    return n;
+}
+
+// =================================================================================
+// --- TRANSMISSÃO ---
+// =================================================================================
+static inline unsigned int uart_tx_count() {
+    return uart_tx_head - uart_tx_tail;
+}
+
+/**
+ * @brief Escreve na FIFO de transmissão tudo o que couber agora (sem bloquear).
+ * @return Quantidade de bytes escritos.
+ */
+static inline int uart_poll_tx() {
+    if (uart_tx_count() == 0) return 0;
+    unsigned int space = IO_JTAG_UART_CONTROL >> UART_WSPACE_SHIFT;
+    int sent = 0;
+    while (space > 0 && uart_tx_count() > 0) {
+        IO_JTAG_UART = uart_tx_buffer[uart_tx_tail++ & (UART_TX_BUFFER_SIZE - 1)];
+        space--;
+        sent++;
+    }
+    return sent;
+}
+
+// Bloqueia até que todo o buffer tenha sido entregue à FIFO
+static inline void uart_flush() {
+    while (uart_tx_count() > 0) {
+        uart_poll_tx();
+    }
+}
+
+static inline void uart_putc(char c) {
+    while (uart_tx_count() == UART_TX_BUFFER_SIZE) {
+        uart_poll_tx(); // Buffer cheio: espera a FIFO abrir espaço
+    }
+    uart_tx_buffer[uart_tx_head++ & (UART_TX_BUFFER_SIZE - 1)] = c;
+    if (c == '\n') uart_flush();
+}
+
+static inline void uart_write(const char *buf, int len) {
+    for (int i = 0; i < len; i++) uart_putc(buf[i]);
+}
+
+static inline void uart_puts(const char *str) {
+    while (*str) uart_putc(*str++);
+}
+
+static inline void uart_printf(const char *format, ...) {
+    char text[UART_LINE_MAX];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (len > (int)sizeof(text) - 1) len = sizeof(text) - 1;
+    if (len > 0) uart_write(text, len);
+}
+
+// =================================================================================
+// --- MONTAGEM DE LINHAS ---
+// =================================================================================
+typedef struct {
+    char text[UART_LINE_MAX];
+    int len;
+    int last_was_cr; // Ignora o '\n' de um par "\r\n"
+} UartLine;
+
+/**
+ * @brief Consome o que houver no buffer e monta a linha atual, com eco e
+ * backspace. Não bloqueia.
+ * @return 1 se uma linha completa foi copiada para 'out', 0 caso contrário.
+ */
+static inline int uart_line_poll(UartLine *line, char *out, int max_len) {
+    char c;
+    int limit = max_len - 1 < UART_LINE_MAX - 1 ? max_len - 1 : UART_LINE_MAX - 1;
+    while (1) {
+        if (!uart_rx_pop(&c)) {
+            uart_poll_tx(); // Entrada esgotada: envia o eco acumulado
+            return 0;
+        }
+
+        if (c == '\n' && line->last_was_cr) {
+            line->last_was_cr = 0;
+            continue;
+        }
+        line->last_was_cr = (c == '\r');
+
+        int done = 0;
+        if (c == '\r' || c == '\n') {
+            uart_putc('\n');
+            done = 1;
+        } else if (c == 8 || c == 127) {    // Backspace ou DEL
+            if (line->len > 0) {
+                line->len--;
+                uart_puts("\b \b");         // Apaga no terminal
+            }
+        } else if (c >= 32 && c <= 126) {   // Caracteres imprimíveis
+            line->text[line->len++] = c;
+            uart_putc(c);                   // Eco na tela (enviado em rajada)
+            done = (line->len >= limit);
+        }
+
+        if (done) {
+            for (int i = 0; i < line->len; i++) out[i] = line->text[i];
+            out[line->len] = '\0';
+            line->len = 0;
+            return 1;
+        }
+    }
+}
+
+#endif
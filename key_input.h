@@ -0,0 +1,174 @@
+#ifndef KEY_INPUT_H
+#define KEY_INPUT_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+
+// =================================================================================
+// --- ENTRADA DOS BOTÕES (KEY0-KEY3) POR EDGE-CAPTURE ---
+// =================================================================================
+// O PIO dos botões guarda no registrador edge-capture (base + 0xC) um bit para
+// cada botão pressionado desde a última limpeza. Lendo esse registrador em vez
+// do nível (*key_ptr), nenhum clique é perdido, mesmo que seja mais curto que
+// um quadro do jogo.
+//
+// Opcionalmente, se KEY_UIO_DEV apontar para o dispositivo UIO do PIO dos
+// botões (ex: KEY_UIO_DEV=/dev/uio0), key_wait() dorme até a interrupção em vez
+// de fazer polling, e as telas paradas não gastam CPU.
+//
+// Uso: #include "key_input.h" num programa que já mapeia os periféricos.
+
+// Índices dos registradores do PIO (palavras de 32 bits)
+#define KEY_REG_DATA           0  // base + 0x0: nível atual dos botões
+#define KEY_REG_INTERRUPTMASK  2  // base + 0x8: habilita interrupção por botão
+#define KEY_REG_EDGECAPTURE    3  // base + 0xC: bordas capturadas
+#define KEY_ALL                0xF
+
+typedef struct {
+    unsigned int keys;          // Botões pressionados (bit 0 = KEY0, ...)
+    uint64_t timestamp_ns;      // CLOCK_MONOTONIC de quando a borda foi lida
+} KeyEvent;
+
+typedef struct {
+    volatile unsigned int *regs;
+    int uio_fd;                 // -1 = sem interrupção (espera por polling)
+    int simulated;
+    unsigned int sim_regs[4];   // Registradores do dispositivo simulado
+} KeyInput;
+
+static inline uint64_t key_now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// Limpa as bordas indicadas. No hardware qualquer escrita limpa o registrador.
+static inline void key_clear(KeyInput *in, unsigned int keys) {
+    if (in->simulated) in->regs[KEY_REG_EDGECAPTURE] &= ~keys;
+    else in->regs[KEY_REG_EDGECAPTURE] = keys;
+}
+
+// Reabilita a interrupção no UIO (o driver a desabilita a cada disparo)
+static inline void key_uio_enable(KeyInput *in) {
+    uint32_t enable = 1;
+    if (write(in->uio_fd, &enable, sizeof(enable)) != sizeof(enable)) {
+        close(in->uio_fd);
+        in->uio_fd = -1; // Volta para polling
+    }
+}
+
+/**
+ * @brief Inicializa a entrada a partir do endereço (já mapeado) do PIO dos botões.
+ * O mapeamento precisa de PROT_WRITE para limpar o edge-capture.
+ */
+static inline void key_input_init(KeyInput *in, volatile void *key_base) {
+    in->regs = (volatile unsigned int *)key_base;
+#ifdef HW_SIM
+    in->simulated = 1; // Registradores em memória comum (backend simulado de hardware.h)
+#else
+    in->simulated = 0;
+#endif
+    in->uio_fd = -1;
+    key_clear(in, KEY_ALL); // Descarta cliques anteriores ao início do programa
+
+    const char *uio_dev = getenv("KEY_UIO_DEV");
+    if (uio_dev != NULL && !in->simulated) {
+        in->uio_fd = open(uio_dev, O_RDWR);
+        if (in->uio_fd != -1) {
+            in->regs[KEY_REG_INTERRUPTMASK] = KEY_ALL;
+            key_uio_enable(in);
+        }
+    }
+}
+
+// Inicializa um dispositivo simulado em memória, para testes sem a placa
+static inline void key_input_init_sim(KeyInput *in) {
+    for (int i = 0; i < 4; i++) in->sim_regs[i] = 0;
+    in->regs = in->sim_regs;
+    in->simulated = 1;
+    in->uio_fd = -1;
+}
+
+static inline void key_input_close(KeyInput *in) {
+    if (in->uio_fd != -1) {
+        if (!in->simulated) in->regs[KEY_REG_INTERRUPTMASK] = 0;
+        close(in->uio_fd);
+        in->uio_fd = -1;
+    }
+}
+
+// Simula um clique: a borda fica registrada mesmo após soltar o botão
+static inline void key_sim_press(KeyInput *in, unsigned int keys) {
+    in->sim_regs[KEY_REG_DATA] |= keys;
+    in->sim_regs[KEY_REG_EDGECAPTURE] |= keys;
+}
+
+static inline void key_sim_release(KeyInput *in, unsigned int keys) {
+    in->sim_regs[KEY_REG_DATA] &= ~keys;
+}
+
+// Nível atual dos botões (equivalente ao antigo *key_ptr)
+static inline unsigned int key_state(KeyInput *in) {
+    return in->regs[KEY_REG_DATA];
+}
+
+/**
+ * @brief Consome as bordas capturadas desde a última chamada, sem bloquear.
+ * @return 1 se houve clique (preenche 'ev'), 0 caso contrário.
+ */
+static inline int key_poll(KeyInput *in, KeyEvent *ev) {
+    unsigned int edges = in->regs[KEY_REG_EDGECAPTURE] & KEY_ALL;
+    if (edges == 0) return 0;
+    key_clear(in, edges);
+    ev->keys = edges;
+    ev->timestamp_ns = key_now_ns();
+    return 1;
+}
+
+/**
+ * @brief Espera até haver um clique pendente, sem consumi-lo (use key_poll depois).
+ * Com UIO dorme na interrupção; sem UIO verifica o edge-capture a cada 1 ms.
+ * No modo simulado só dorme: até o prazo, ou um quadro se timeout_ms = -1.
+ * @param timeout_ms Tempo máximo de espera, ou -1 para esperar indefinidamente.
+ * @return 1 se há clique pendente, 0 se o tempo acabou.
+ */
+static inline int key_wait(KeyInput *in, int timeout_ms) {
+    uint64_t deadline = key_now_ns() + (uint64_t)timeout_ms * 1000000ull;
+    while (1) {
+        if (in->regs[KEY_REG_EDGECAPTURE] & KEY_ALL) return 1;
+        if (in->simulated) {
+            // Ninguém aperta os botões simulados durante a espera: dorme até o
+            // prazo (um quadro, se a espera é indefinida) em vez de voltar na hora
+            // e deixar o chamador num laço ocupado
+            long wait_ms = timeout_ms >= 0 ? timeout_ms : 16;
+            struct timespec ts = { wait_ms / 1000, (wait_ms % 1000) * 1000000L };
+            nanosleep(&ts, NULL);
+            return 0;
+        }
+
+        int remaining_ms = -1;
+        if (timeout_ms >= 0) {
+            uint64_t now = key_now_ns();
+            if (now >= deadline) return 0;
+            remaining_ms = (int)((deadline - now) / 1000000ull) + 1;
+        }
+
+        if (in->uio_fd != -1) {
+            struct pollfd pfd = { .fd = in->uio_fd, .events = POLLIN };
+            if (poll(&pfd, 1, remaining_ms) > 0) {
+                uint32_t irq_count;
+                if (read(in->uio_fd, &irq_count, sizeof(irq_count)) == sizeof(irq_count)) {
+                    key_uio_enable(in);
+                }
+            }
+        } else {
+            usleep(1000);
+        }
+    }
+}
+
+#endif
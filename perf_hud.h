@@ -0,0 +1,122 @@
+#ifndef PERF_HUD_H
+#define PERF_HUD_H
+
+#include <stdint.h>
+#include <time.h>
+#include "hex_display.h"
+
+// =================================================================================
+// --- HUD DE DESEMPENHO NOS DISPLAYS E NOS LEDS ---
+// =================================================================================
+// Mostra o desempenho do jogo sem depender do console:
+//
+//   HEX5-HEX0   SW0 desligada: "F   60"  quadros por segundo
+//               SW0 ligada:    "t   17"  duração média do quadro, em ms
+//   LEDR9-0     barra de uso do orçamento de um quadro a 60 Hz: tempo de
+//               desenho / 16,6 ms, um LED a cada 10% (todos acesos = estourou)
+//
+// Por quadro só há duas leituras do relógio (vDSO, sem chamada de sistema)
+// e algumas somas; displays, LEDs e chaves são tocados apenas HUD_UPDATE_MS
+// vezes por segundo, e os displays só quando o valor muda (hex_display.h).
+//
+// Uso: hud_init() depois de mapear os periféricos; hud_frame_begin() antes de
+// atualizar e desenhar o quadro, hud_frame_end() logo depois (antes da espera
+// do próximo quadro) e hud_close() ao sair.
+
+#define HUD_UPDATE_MS    250
+#define HUD_BUDGET_NS    16666667ull  // Um quadro a 60 Hz
+#define HUD_METRIC_SW    0x1          // SW0 escolhe a métrica dos displays
+#define HUD_LED_COUNT    10
+
+typedef struct {
+    HexDisplay hex;
+    volatile unsigned int *ledr;
+    volatile unsigned int *sw;
+    unsigned int ledr_shadow;
+    uint64_t frame_start_ns;
+    uint64_t window_start_ns;   // Início do intervalo de medida atual
+    uint64_t render_ns;         // Soma do tempo de desenho no intervalo
+    unsigned int frames;        // Quadros no intervalo
+} PerfHud;
+
+static inline uint64_t hud_now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static inline void hud_init(PerfHud *hud, volatile unsigned int *hex3_0, volatile unsigned int *hex5_4,
+                            volatile unsigned int *ledr, volatile unsigned int *sw) {
+    hex_init(&hud->hex, hex3_0, hex5_4);
+    hud->ledr = ledr;
+    hud->sw = sw;
+    hud->ledr_shadow = 0;
+    *hud->ledr = 0;
+    hud->frame_start_ns = 0;
+    hud->window_start_ns = hud_now_ns();
+    hud->render_ns = 0;
+    hud->frames = 0;
+    hex_show_text(&hud->hex, "------");
+}
+
+static inline void hud_frame_begin(PerfHud *hud) {
+    hud->frame_start_ns = hud_now_ns();
+}
+
+// Atualiza displays e LEDs com as médias do intervalo que terminou
+static inline void hud_refresh(PerfHud *hud, uint64_t now) {
+    uint64_t elapsed = now - hud->window_start_ns;
+    uint32_t word3_0, word5_4;
+    char metric;
+
+    if (*hud->sw & HUD_METRIC_SW) {
+        unsigned int frame_ms = (unsigned int)((elapsed / hud->frames + 500000) / 1000000);
+        hex_pack_number(frame_ms > 99999 ? 99999 : frame_ms, 1, &word3_0, &word5_4);
+        metric = 't';
+    } else {
+        unsigned int fps = (unsigned int)((hud->frames * 1000000000ull + elapsed / 2) / elapsed);
+        hex_pack_number(fps, 1, &word3_0, &word5_4);
+        metric = 'F';
+    }
+    // Valor em HEX4-HEX0 e a letra da métrica em HEX5: uma escrita por registrador
+    word5_4 = (word5_4 & 0x00FF) | (hex_char_codes[(int)metric] << 8);
+    hex_commit(&hud->hex, word3_0, word5_4);
+
+    // Uso do orçamento: tempo médio de desenho / 16,6 ms, arredondado para cima
+    uint64_t render_avg = hud->render_ns / hud->frames;
+    unsigned int lit = (unsigned int)((render_avg * HUD_LED_COUNT + HUD_BUDGET_NS - 1) / HUD_BUDGET_NS);
+    if (lit > HUD_LED_COUNT) lit = HUD_LED_COUNT;
+    unsigned int bar = (1u << lit) - 1;
+    if (bar != hud->ledr_shadow) {
+        *hud->ledr = bar;
+        hud->ledr_shadow = bar;
+    }
+
+    hud->window_start_ns = now;
+    hud->render_ns = 0;
+    hud->frames = 0;
+}
+
+static inline void hud_frame_end(PerfHud *hud) {
+    uint64_t now = hud_now_ns();
+    hud->render_ns += now - hud->frame_start_ns;
+    hud->frames++;
+    if (now - hud->window_start_ns >= HUD_UPDATE_MS * 1000000ull) {
+        hud_refresh(hud, now);
+    }
+}
+
+// Descarta o intervalo atual (ex: depois de uma pausa esperando um botão)
+static inline void hud_restart(PerfHud *hud) {
+    hud->window_start_ns = hud_now_ns();
+    hud->render_ns = 0;
+    hud->frames = 0;
+}
+
+static inline void hud_close(PerfHud *hud) {
+    hex_clear(&hud->hex);
+    *hud->ledr = 0;
+    hud->ledr_shadow = 0;
+}
+
+#endif
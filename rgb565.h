@@ -0,0 +1,179 @@
+#ifndef RGB565_H
+#define RGB565_H
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define RGB565_KERNEL "NEON"
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define RGB565_KERNEL "SSE2"
+#else
+#define RGB565_KERNEL "escalar"
+#endif
+
+// =================================================================================
+// --- CONVERSÃO RGB888 -> RGB565 ---
+// =================================================================================
+// Converte uma linha de pixels de 3 bytes (R,G,B como no PPM, ou B,G,R como
+// no BMP) para o formato da VGA. rgb565_row() descarta os bits menos
+// significativos; rgb565_dither_row() soma antes um limiar da matriz de Bayer
+// 4x4 (0-7 em R e B, 0-3 em G), o que troca as faixas de um degradê por um
+// padrão fino cuja média é a cor original. Os níveis de 5 bits valem 255/31 na
+// tela, não 8: cada canal é antes escalado para v - v/32 (v - v/64 no verde),
+// senão a média sobe até 4 unidades nas cores claras. Com a escala, v + limiar
+// nunca passa de 255 e não é preciso saturar.
+//
+//   NEON (ARMv7 da placa)  16 pixels por volta: vld3q_u8 separa os canais e
+//                          vshll/vsri montam os pixels de 16 bits
+//   SSE2 (PC, HW_SIM)      8 pixels por volta: 4 pixels por registrador,
+//                          lidos com cargas de 32 bits desalinhadas
+//   escalar                o resto da linha e arquiteturas sem SIMD
+//
+// Uso: rgb565_row(destino, origem, n, bgr) para n pixels, ou
+// rgb565_dither_row(destino, origem, n, bgr, x, y) com (x, y) = posição na
+// tela do primeiro pixel, para o padrão ficar fixo na tela.
+
+static inline uint16_t rgb565_pack(unsigned int r, unsigned int g, unsigned int b) {
+    return (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
+
+static inline void rgb565_row_scalar(uint16_t *dst, const uint8_t *src, int n, int bgr) {
+    int ri = bgr ? 2 : 0, bi = bgr ? 0 : 2;
+    for (int i = 0; i < n; i++, src += 3) {
+        dst[i] = rgb565_pack(src[ri], src[1], src[bi]);
+    }
+}
+
+// Matriz de Bayer 4x4 (0-15)
+static const uint8_t rgb565_bayer[4][4] = {
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 }
+};
+
+static inline void rgb565_dither_row_scalar(uint16_t *dst, const uint8_t *src, int n, int bgr, int x, int y) {
+    int ri = bgr ? 2 : 0, bi = bgr ? 0 : 2;
+    const uint8_t *bayer = rgb565_bayer[y & 3];
+    for (int i = 0; i < n; i++, src += 3) {
+        unsigned int t = bayer[(x + i) & 3], r = src[ri], g = src[1], b = src[bi];
+        dst[i] = rgb565_pack(r - (r >> 5) + (t >> 1), g - (g >> 6) + (t >> 2), b - (b >> 5) + (t >> 1));
+    }
+}
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+// r nos bits 15:8; vsri insere g >> 5 e b >> 11 mantendo os bits de cima
+static inline uint16x8_t rgb565_neon_pack(uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+    uint16x8_t px = vshll_n_u8(r, 8);
+    px = vsriq_n_u16(px, vshll_n_u8(g, 8), 5);
+    return vsriq_n_u16(px, vshll_n_u8(b, 8), 11);
+}
+#endif
+
+#if defined(__SSE2__) && !defined(__ARM_NEON) && !defined(__ARM_NEON__)
+// Quatro pixels de 3 bytes, um por palavra de 32 bits (o 4º byte é ignorado)
+static inline __m128i rgb565_load4(const uint8_t *src) {
+    uint32_t w0, w1, w2, w3;
+    memcpy(&w0, src, 4);
+    memcpy(&w1, src + 3, 4);
+    memcpy(&w2, src + 6, 4);
+    memcpy(&w3, src + 9, 4);
+    return _mm_set_epi32((int)w3, (int)w2, (int)w1, (int)w0);
+}
+
+// Palavra 0x00BBGGRR (ou 0x00RRGGBB com bgr) -> RGB565 nos 16 bits baixos
+static inline __m128i rgb565_pack4(__m128i px, int bgr) {
+    __m128i c0 = _mm_and_si128(px, _mm_set1_epi32(0xF8));         // 1º byte
+    __m128i c1 = _mm_and_si128(_mm_srli_epi32(px, 8), _mm_set1_epi32(0xFC));
+    __m128i c2 = _mm_and_si128(_mm_srli_epi32(px, 16), _mm_set1_epi32(0xF8));
+    __m128i r = bgr ? c2 : c0, b = bgr ? c0 : c2;
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(r, 8), _mm_slli_epi32(c1, 3)), _mm_srli_epi32(b, 3));
+}
+
+// Junta dois vetores de 4 x 32 bits em 8 x 16 bits (packs é com sinal: desloca a faixa)
+static inline __m128i rgb565_narrow(__m128i lo, __m128i hi) {
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16((short)0x8000);
+    return _mm_add_epi16(_mm_packs_epi32(_mm_sub_epi32(lo, bias32), _mm_sub_epi32(hi, bias32)), bias16);
+}
+#endif
+
+/**
+ * @brief Converte n pixels RGB888 (ou BGR888) de 'src' para RGB565 em 'dst'.
+ * 'dst' é memória comum; para a VGA, converter numa cópia e usar blit_present().
+ */
+static inline void rgb565_row(uint16_t *dst, const uint8_t *src, int n, int bgr) {
+    int i = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; i + 16 <= n; i += 16) {
+        uint8x16x3_t c = vld3q_u8(src + 3 * i);
+        uint8x16_t r = bgr ? c.val[2] : c.val[0];
+        uint8x16_t b = bgr ? c.val[0] : c.val[2];
+        vst1q_u16(dst + i, rgb565_neon_pack(vget_low_u8(r), vget_low_u8(c.val[1]), vget_low_u8(b)));
+        vst1q_u16(dst + i + 8, rgb565_neon_pack(vget_high_u8(r), vget_high_u8(c.val[1]), vget_high_u8(b)));
+    }
+#elif defined(__SSE2__)
+    // A carga de 32 bits do último pixel lê um byte além dele: para antes do fim
+    for (; i + 8 < n; i += 8) {
+        __m128i lo = rgb565_pack4(rgb565_load4(src + 3 * i), bgr);
+        __m128i hi = rgb565_pack4(rgb565_load4(src + 3 * i + 12), bgr);
+        _mm_storeu_si128((__m128i *)(dst + i), rgb565_narrow(lo, hi));
+    }
+#endif
+    rgb565_row_scalar(dst + i, src + 3 * i, n - i, bgr);
+}
+
+/**
+ * @brief Como rgb565_row(), com pontilhado ordenado (Bayer 4x4).
+ * @param x, y Posição na tela do primeiro pixel (escolhe os limiares).
+ * Como a matriz se repete a cada 4 colunas, os limiares de um bloco de 8 ou
+ * 16 pixels são os mesmos em toda a linha: um vetor montado uma vez.
+ */
+static inline void rgb565_dither_row(uint16_t *dst, const uint8_t *src, int n, int bgr, int x, int y) {
+    int i = 0;
+    const uint8_t *bayer = rgb565_bayer[y & 3];
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    uint8_t t_rb[16], t_g[16];
+    for (int k = 0; k < 16; k++) {
+        t_rb[k] = bayer[(x + k) & 3] >> 1;
+        t_g[k] = bayer[(x + k) & 3] >> 2;
+    }
+    uint8x16_t v_rb = vld1q_u8(t_rb), v_g = vld1q_u8(t_g);
+    for (; i + 16 <= n; i += 16) {
+        uint8x16x3_t c = vld3q_u8(src + 3 * i);
+        uint8x16_t r = bgr ? c.val[2] : c.val[0], g = c.val[1], b = bgr ? c.val[0] : c.val[2];
+        r = vaddq_u8(vsubq_u8(r, vshrq_n_u8(r, 5)), v_rb);
+        g = vaddq_u8(vsubq_u8(g, vshrq_n_u8(g, 6)), v_g);
+        b = vaddq_u8(vsubq_u8(b, vshrq_n_u8(b, 5)), v_rb);
+        vst1q_u16(dst + i, rgb565_neon_pack(vget_low_u8(r), vget_low_u8(g), vget_low_u8(b)));
+        vst1q_u16(dst + i + 8, rgb565_neon_pack(vget_high_u8(r), vget_high_u8(g), vget_high_u8(b)));
+    }
+#elif defined(__SSE2__)
+    // Um limiar por byte da palavra do pixel: o de R/B nos bytes 0 e 2, o de G no 1.
+    // Sem deslocamento por byte no SSE2: desloca a palavra e a máscara deixa em
+    // cada byte só os bits que vieram dele mesmo (v >> 5 em R/B, v >> 6 em G)
+    uint32_t t[4];
+    for (int k = 0; k < 4; k++) {
+        uint32_t b = bayer[(x + k) & 3];
+        t[k] = (b >> 1) | ((b >> 2) << 8) | ((b >> 1) << 16);
+    }
+    __m128i thresholds = _mm_set_epi32((int)t[3], (int)t[2], (int)t[1], (int)t[0]);
+    const __m128i mask_rb = _mm_set1_epi32(0x070007), mask_g = _mm_set1_epi32(0x0300);
+    for (; i + 8 < n; i += 8) {
+        __m128i lo = rgb565_load4(src + 3 * i), hi = rgb565_load4(src + 3 * i + 12);
+        lo = _mm_sub_epi8(lo, _mm_or_si128(_mm_and_si128(_mm_srli_epi32(lo, 5), mask_rb), _mm_and_si128(_mm_srli_epi32(lo, 6), mask_g)));
+        hi = _mm_sub_epi8(hi, _mm_or_si128(_mm_and_si128(_mm_srli_epi32(hi, 5), mask_rb), _mm_and_si128(_mm_srli_epi32(hi, 6), mask_g)));
+        lo = _mm_add_epi8(lo, thresholds);
+        hi = _mm_add_epi8(hi, thresholds);
+        _mm_storeu_si128((__m128i *)(dst + i), rgb565_narrow(rgb565_pack4(lo, bgr), rgb565_pack4(hi, bgr)));
+    }
+#else
+    (void)bayer;
+#endif
+    rgb565_dither_row_scalar(dst + i, src + 3 * i, n - i, bgr, x + i, y);
+}
+
+#endif
@@ -4,18 +4,16 @@
 #include <string.h>
 #include <stdint.h>
 #include <unistd.h>
-#include <fcntl.h>
-#include <sys/mman.h>
 #include <time.h>
+#include "hardware.h"
+#include "key_input.h"
+#include "perf_hud.h"
+#include "compositor.h"
+#include "text_overlay.h"
 
 // =================================================================================
 // --- CONFIGURAÇÕES DE HARDWARE E TELA ---
 // =================================================================================
-#define PERIPHERAL_BASE 0xFF200000
-#define PERIPHERAL_SIZE 0x00001000 
-#define DEVICES_BUTTONS 0x0050
-
-#define FRAME_BASE      0xC8000000
 #define LWIDTH          512
 #define VISIBLE_WIDTH   320
 #define VISIBLE_HEIGHT  240
@@ -24,10 +22,14 @@
 // =================================================================================
 // --- CONFIGURAÇÕES DO JOGO ---
 // =================================================================================
-#define GRID_SIZE            8
+#ifndef GRID_SIZE
+#define GRID_SIZE            8  // Pode ser redefinido na compilação (ex: -DGRID_SIZE=1)
+#endif
+#define GRID_GAP             (GRID_SIZE > 1 ? 1 : 0) // Espaço de grade entre as células
 #define GRID_WIDTH           (VISIBLE_WIDTH / GRID_SIZE)  // 40
 #define GRID_HEIGHT          (VISIBLE_HEIGHT / GRID_SIZE) // 30
-#define MAX_SNAKE_LENGTH     (GRID_WIDTH * GRID_HEIGHT)
+#define GRID_CELLS           (GRID_WIDTH * GRID_HEIGHT)
+#define MAX_SNAKE_LENGTH     GRID_CELLS
 #define INITIAL_SNAKE_LENGTH 5
 #define INITIAL_SPEED_DELAY  100000 // usleep delay inicial (maior = mais lento)
 
@@ -43,6 +45,12 @@
 #define TEXT_BG_COLOR    0x4208 // Fundo para texto de Game Over
 #define TEXT_COLOR       WHITE
 
+// Linhas do buffer de caracteres (cada uma cobre 4 pixels da tela)
+#define TEXT_SCORE_ROW   0
+#define TEXT_TITLE_ROW   (TEXT_ROWS / 2 - 8)  // Tela inicial
+#define TEXT_HINT_ROW    (TEXT_ROWS / 2 + 4)
+#define TEXT_OVER_ROW    (TEXT_ROWS / 2 - 3)  // "GAME OVER", dentro do fundo da mensagem
+
 // =================================================================================
 // --- ESTRUTURAS E ESTADOS DE JOGO ---
 // =================================================================================
@@ -64,54 +72,73 @@ typedef struct {
 // --- VARIÁVEIS GLOBAIS ---
 // =================================================================================
 // Hardware
-int mem_fd = -1;
 volatile uint16_t (*tela)[LWIDTH];
-volatile void *peripheral_map = NULL;
-volatile unsigned int *key_ptr = NULL;
+KeyInput keys;                  // Botões via edge-capture (ver key_input.h)
+PerfHud hud;                    // Ticks por segundo nos displays e carga nos LEDs
+CompSurface surface;            // Superfície do compositor (ver compositor.h)
+TextOverlay text;               // Mensagens e placar (ver text_overlay.h)
+int compositing = 0;            // 1 = desenha na superfície em vez da VGA
 // Jogo
 GameState state;
+// O corpo da cobra é um buffer circular: snake_head aponta para a cabeça e
+// snake_tail para o último segmento. Mover e crescer custam O(1).
 Point snake_body[MAX_SNAKE_LENGTH];
+int snake_head;
+int snake_tail;
 int snake_length;
 Direction direction;
 Point food;
 int score;
+// Mapa de ocupação (1 bit por célula) para checar colisão em O(1) e conjunto
+// indexado das células livres para sortear a comida em O(1).
+uint32_t occupancy[(GRID_CELLS + 31) / 32];
+int free_cells[GRID_CELLS];     // Células livres (índice y * GRID_WIDTH + x)
+int free_slot[GRID_CELLS];      // Posição de cada célula em free_cells (-1 = ocupada)
+int free_count;
+// Renderização incremental: o que mudou no último tick
+int needs_full_redraw = 1;      // Redesenha a tela inteira (transições de estado)
+Point prev_head;                // Cabeça antes do tick (vira corpo)
+Point vacated_tail;             // Célula liberada pela cauda
+int tail_vacated;
+int food_moved;
 
 // =================================================================================
 // --- FUNÇÕES DE HARDWARE E DESENHO ---
 // =================================================================================
 void cleanup_resources() {
     // A função atexit() garante que isto seja chamado ao sair
-    if (tela) munmap((void*)tela, LWIDTH * VISIBLE_HEIGHT * PIXEL_SIZE);
-    if (peripheral_map) munmap((void*)peripheral_map, PERIPHERAL_SIZE);
-    if (mem_fd != -1) close(mem_fd);
+    key_input_close(&keys);
+    if (compositing) comp_surface_close(&surface);
+    hud_close(&hud);
+    text_clear(&text);
+    hw_close();
     printf("\nRecursos liberados. Saindo do jogo.\n");
 }
 
 int init_hardware() {
-    mem_fd = open("/dev/mem", O_RDWR | O_SYNC);
-    if (mem_fd == -1) { 
-        perror("Erro ao abrir /dev/mem"); 
-        return -1; 
-    }
-    
-    // Mapear framebuffer da VGA
-    void* vga_map = mmap(NULL, LWIDTH * VISIBLE_HEIGHT * PIXEL_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, FRAME_BASE);
-    if (vga_map == MAP_FAILED) { 
-        perror("Erro ao mapear VGA"); 
-        close(mem_fd); 
-        return -1; 
-    }
-    tela = (volatile uint16_t (*)[LWIDTH])vga_map;
-
-    // Mapear periféricos (botões)
-    peripheral_map = mmap(NULL, PERIPHERAL_SIZE, PROT_READ, MAP_SHARED, mem_fd, PERIPHERAL_BASE);
-    if (peripheral_map == MAP_FAILED) { 
-        perror("Erro ao mapear periféricos"); 
-        munmap(vga_map, LWIDTH * VISIBLE_HEIGHT * PIXEL_SIZE); 
-        close(mem_fd); 
-        return -1; 
+    if (hw_init() != 0) return -1;
+
+    // Com VGA_COMPOSITOR definido, desenha numa superfície do compositor;
+    // senão, direto no framebuffer da VGA
+    int comp_x, comp_y, comp_z;
+    if (comp_env_geometry(&comp_x, &comp_y, &comp_z)) {
+        if (comp_surface_open(&surface, comp_x, comp_y, VISIBLE_WIDTH, VISIBLE_HEIGHT, comp_z) != 0) {
+            fprintf(stderr, "Erro ao abrir superficie do compositor\n");
+            hw_close();
+            return -1;
+        }
+        tela = (volatile uint16_t (*)[LWIDTH])surface.pixels;
+        compositing = 1;
+    } else {
+        tela = hw_framebuffer();
     }
-    key_ptr = (volatile unsigned int *)(peripheral_map + DEVICES_BUTTONS);
+
+    // Botões; o mapeamento tem escrita, necessária para limpar o edge-capture
+    key_input_init(&keys, hw_reg(KEY_OFFSET));
+    hud_init(&hud, hw_reg(HEX3_0_OFFSET), hw_reg(HEX5_4_OFFSET), hw_reg(LEDR_OFFSET), hw_reg(SW_OFFSET));
+    // O buffer de caracteres cobre a tela inteira: numa superfície do
+    // compositor o texto sairia fora da janela, então fica desligado
+    text_init(&text, compositing ? NULL : hw_charbuffer());
 
     atexit(cleanup_resources);
     return 0;
@@ -120,13 +147,14 @@ int init_hardware() {
 void draw_grid_rect(int grid_x, int grid_y, uint16_t color) {
     int start_x = grid_x * GRID_SIZE;
     int start_y = grid_y * GRID_SIZE;
-    for (int y = 0; y < GRID_SIZE - 1; y++) { // Deixa 1 pixel de espaço para efeito de grade
-        for (int x = 0; x < GRID_SIZE - 1; x++) {
+    for (int y = 0; y < GRID_SIZE - GRID_GAP; y++) { // Deixa 1 pixel de espaço para efeito de grade
+        for (int x = 0; x < GRID_SIZE - GRID_GAP; x++) {
             if ( (start_y + y < VISIBLE_HEIGHT) && (start_x + x < VISIBLE_WIDTH) && (start_y + y >=0) && (start_x +x >= 0) ) {
                 tela[start_y + y][start_x + x] = color;
             }
         }
     }
+    if (compositing) comp_damage(&surface, start_x, start_y, start_x + GRID_SIZE, start_y + GRID_SIZE);
 }
 
 void fill_screen(uint16_t color) {
@@ -135,136 +163,298 @@ void fill_screen(uint16_t color) {
             tela[y][x] = color;
         }
     }
+    if (compositing) comp_damage(&surface, 0, 0, VISIBLE_WIDTH, VISIBLE_HEIGHT);
 }
 
 // =================================================================================
 // --- LÓGICA DO JOGO ---
 // =================================================================================
-void place_food() {
-    int on_snake;
-    do {
-        on_snake = 0;
-        food.x = rand() % GRID_WIDTH;
-        food.y = rand() % GRID_HEIGHT;
-        // Garante que a comida não apareça na cobra
-        for (int i = 0; i < snake_length; i++) {
-            if (food.x == snake_body[i].x && food.y == snake_body[i].y) {
-                on_snake = 1;
-                break;
-            }
-        }
-    } while (on_snake);
+// Troca de estado; qualquer transição força um redesenho completo
+void set_state(GameState new_state) {
+    if (new_state != state) needs_full_redraw = 1;
+    state = new_state;
+}
+
+// Retorna o i-ésimo segmento da cobra contado a partir da cabeça (0 = cabeça)
+Point* snake_segment(int i) {
+    int idx = snake_head - i;
+    if (idx < 0) idx += MAX_SNAKE_LENGTH;
+    return &snake_body[idx];
+}
+
+int cell_index(int x, int y) {
+    return y * GRID_WIDTH + x;
+}
+
+int is_occupied(int x, int y) {
+    int cell = cell_index(x, y);
+    return (occupancy[cell >> 5] >> (cell & 31)) & 1;
+}
+
+void mark_occupied(int x, int y) {
+    int cell = cell_index(x, y);
+    occupancy[cell >> 5] |= 1u << (cell & 31);
+    // Remove do conjunto de livres trocando com o último elemento
+    int slot = free_slot[cell];
+    int last = free_cells[--free_count];
+    free_cells[slot] = last;
+    free_slot[last] = slot;
+    free_slot[cell] = -1;
+}
+
+void mark_free(int x, int y) {
+    int cell = cell_index(x, y);
+    occupancy[cell >> 5] &= ~(1u << (cell & 31));
+    free_cells[free_count] = cell;
+    free_slot[cell] = free_count++;
+}
+
+void reset_occupancy() {
+    memset(occupancy, 0, sizeof(occupancy));
+    for (int cell = 0; cell < GRID_CELLS; cell++) {
+        free_cells[cell] = cell;
+        free_slot[cell] = cell;
+    }
+    free_count = GRID_CELLS;
+}
+
+// Sorteia a comida entre as células livres. Retorna 0 se o tabuleiro estiver cheio.
+int place_food() {
+    if (free_count == 0) {
+        food.x = -1;
+        food.y = -1;
+        return 0;
+    }
+    int cell = free_cells[rand() % free_count];
+    food.x = cell % GRID_WIDTH;
+    food.y = cell / GRID_WIDTH;
+    return 1;
 }
 
 void init_game() {
-    state = STATE_GAME_RUNNING;
+    set_state(STATE_GAME_RUNNING);
     snake_length = INITIAL_SNAKE_LENGTH;
     direction = RIGHT;
     score = 0;
     
-    // Cria a cobra inicial no centro da tela
+    // Cria a cobra inicial no centro da tela (cauda no índice 0, cabeça no fim)
     int start_x = GRID_WIDTH / 2;
     int start_y = GRID_HEIGHT / 2;
+    snake_tail = 0;
+    snake_head = snake_length - 1;
+    reset_occupancy();
     for (int i = 0; i < snake_length; i++) {
-        snake_body[i].x = start_x - i;
-        snake_body[i].y = start_y;
+        snake_segment(i)->x = start_x - i;
+        snake_segment(i)->y = start_y;
+        mark_occupied(start_x - i, start_y);
     }
     
     place_food();
-    fill_screen(BG_COLOR); // Limpa a tela para um novo jogo
+    needs_full_redraw = 1; // Limpa a tela para um novo jogo
+    text_clear(&text);
     printf("Jogo iniciado! Pontuacao: 0\n");
 }
 
 void update_game_state() {
+    // --- Calcula a nova posição da cabeça ---
+    Point new_head = *snake_segment(0);
+    prev_head = new_head;
+    tail_vacated = 0;
+    food_moved = 0;
+    if (direction == UP) new_head.y--;
+    if (direction == DOWN) new_head.y++;
+    if (direction == LEFT) new_head.x--;
+    if (direction == RIGHT) new_head.x++;
+
     // --- Move a cobra ---
-    // Cada segmento do corpo se move para a posição do segmento da frente
-    for (int i = snake_length - 1; i > 0; i--) {
-        snake_body[i] = snake_body[i - 1];
+    // Em vez de deslocar o vetor inteiro, a cauda avança (liberando a última
+    // célula) e a cabeça é escrita na próxima posição do buffer circular.
+    // Ao comer, a cauda fica parada e a cobra cresce um segmento.
+    int ate = (new_head.x == food.x && new_head.y == food.y) && snake_length < MAX_SNAKE_LENGTH;
+    if (ate) {
+        snake_length++;
+    } else {
+        vacated_tail = snake_body[snake_tail];
+        tail_vacated = 1;
+        mark_free(snake_body[snake_tail].x, snake_body[snake_tail].y);
+        snake_tail = (snake_tail + 1) % MAX_SNAKE_LENGTH;
     }
-
-    // Move a cabeça de acordo com a direção atual
-    Point* head = &snake_body[0];
-    if (direction == UP) head->y--;
-    if (direction == DOWN) head->y++;
-    if (direction == LEFT) head->x--;
-    if (direction == RIGHT) head->x++;
+    snake_head = (snake_head + 1) % MAX_SNAKE_LENGTH;
+    snake_body[snake_head] = new_head;
+    Point* head = &snake_body[snake_head];
 
     // --- Verifica colisões ---
     // 1. Colisão com as paredes
     if (head->x < 0 || head->x >= GRID_WIDTH || head->y < 0 || head->y >= GRID_HEIGHT) {
-        state = STATE_GAME_OVER;
+        set_state(STATE_GAME_OVER);
         return;
     }
 
-    // 2. Colisão com o próprio corpo
-    for (int i = 1; i < snake_length; i++) {
-        if (head->x == snake_body[i].x && head->y == snake_body[i].y) {
-            state = STATE_GAME_OVER;
-            return;
-        }
+    // 2. Colisão com o próprio corpo (consulta ao mapa de ocupação)
+    if (is_occupied(head->x, head->y)) {
+        set_state(STATE_GAME_OVER);
+        return;
     }
+    mark_occupied(head->x, head->y);
 
     // 3. Colisão com a comida
     if (head->x == food.x && head->y == food.y) {
-        if (snake_length < MAX_SNAKE_LENGTH) {
-            // Para crescer, simplesmente aumentamos o comprimento.
-            // O algoritmo de movimento fará o resto.
-            snake_body[snake_length] = snake_body[snake_length - 1];
-            snake_length++;
-        }
         score += 10;
         printf("Comeu! Pontuacao: %d\n", score);
-        place_food();
+        food_moved = 1;
+        if (!place_food()) {
+            printf("Tabuleiro completo!\n");
+            set_state(STATE_GAME_OVER);
+        }
     }
 }
 
+// Redesenho completo, usado apenas quando o estado do jogo muda
 void draw_game_elements() {
-    // Desenha a tela inteira (pode ser otimizado para apenas desenhar o que mudou)
     fill_screen(BG_COLOR);
     // Desenha a comida
     draw_grid_rect(food.x, food.y, RED);
     // Desenha a cobra
     for (int i = 0; i < snake_length; i++) {
         uint16_t color = (i == 0) ? LIME_GREEN : GREEN;
-        draw_grid_rect(snake_body[i].x, snake_body[i].y, color);
+        draw_grid_rect(snake_segment(i)->x, snake_segment(i)->y, color);
+    }
+}
+
+// Desenha apenas o que mudou no último tick: apaga a célula liberada pela cauda,
+// pinta a cabeça anterior como corpo, a nova cabeça e a comida se ela mudou.
+void draw_game_changes() {
+    if (tail_vacated) draw_grid_rect(vacated_tail.x, vacated_tail.y, BG_COLOR);
+    draw_grid_rect(prev_head.x, prev_head.y, GREEN);
+    Point* head = snake_segment(0);
+    draw_grid_rect(head->x, head->y, LIME_GREEN);
+    if (food_moved) draw_grid_rect(food.x, food.y, RED);
+}
+
+// =================================================================================
+// --- BENCHMARK ---
+// =================================================================================
+// Direção a seguir num ciclo hamiltoniano do tabuleiro: a linha 0 e as demais
+// linhas em zigue-zague pelas colunas 1..N, voltando pela coluna 0. A cobra
+// nunca colide seguindo este ciclo, qualquer que seja o seu comprimento.
+Direction cycle_direction(int x, int y) {
+    if (x == 0) return (y == 0) ? RIGHT : UP;
+    if (y % 2 == 0) return (x == GRID_WIDTH - 1) ? DOWN : RIGHT;
+    if (x == 1 && y != GRID_HEIGHT - 1) return DOWN;
+    return LEFT;
+}
+
+double elapsed_ns(struct timespec *start, struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+// Mede o tempo de update_game_state() e de place_food() para vários comprimentos.
+// Executado com "./snake --bench", sem acesso ao hardware.
+void run_benchmark() {
+    if (GRID_HEIGHT % 2 != 0) {
+        printf("Benchmark requer GRID_HEIGHT par (atual: %d).\n", GRID_HEIGHT);
+        return;
+    }
+    const int lengths[] = { INITIAL_SNAKE_LENGTH, 50, GRID_CELLS / 4, GRID_CELLS / 2, GRID_CELLS * 3 / 4, GRID_CELLS - 1 };
+    const int ticks = 100000;
+    struct timespec t0, t1;
+
+    printf("Grade %dx%d (%d celulas)\n", GRID_WIDTH, GRID_HEIGHT, GRID_CELLS);
+    printf("%10s %15s %20s\n", "tamanho", "tick (ns)", "place_food (ns)");
+    for (unsigned int n = 0; n < sizeof(lengths) / sizeof(lengths[0]); n++) {
+        int len = lengths[n];
+        if (len > GRID_CELLS - 1) continue;
+
+        // Monta a cobra ao longo do ciclo, da cauda para a cabeça
+        state = STATE_GAME_RUNNING;
+        reset_occupancy();
+        snake_length = len;
+        snake_tail = 0;
+        snake_head = len - 1;
+        int x = 0, y = 0;
+        for (int i = 0; i < len; i++) {
+            snake_body[i].x = x;
+            snake_body[i].y = y;
+            mark_occupied(x, y);
+            Direction d = cycle_direction(x, y);
+            if (d == UP) y--;
+            if (d == DOWN) y++;
+            if (d == LEFT) x--;
+            if (d == RIGHT) x++;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (int i = 0; i < ticks; i++) place_food();
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double food_ns = elapsed_ns(&t0, &t1) / ticks;
+
+        // Comida fora do tabuleiro: o comprimento permanece constante
+        food.x = -1;
+        food.y = -1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (int i = 0; i < ticks; i++) {
+            Point* head = snake_segment(0);
+            direction = cycle_direction(head->x, head->y);
+            update_game_state();
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        if (state != STATE_GAME_RUNNING) {
+            printf("Erro: a cobra colidiu durante o benchmark.\n");
+            return;
+        }
+        printf("%10d %15.1f %20.1f\n", len, elapsed_ns(&t0, &t1) / ticks, food_ns);
     }
 }
 
 // =================================================================================
 // --- FUNÇÃO PRINCIPAL ---
 // =================================================================================
-int main() {
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        run_benchmark();
+        return 0;
+    }
+
     if (init_hardware() != 0) { return 1; }
     srand(time(NULL));
 
     state = STATE_START_SCREEN;
-    unsigned int prev_key_state = 0x0;
+    needs_full_redraw = 1;
 
     while (1) {
-        unsigned int current_key_state = *key_ptr;
-        if (current_key_state & 0b0001) { break; } // Sair com KEY0
+        hud_frame_begin(&hud);
+
+        // Cliques capturados desde o último tick (nenhum é perdido entre ticks)
+        KeyEvent ev;
+        unsigned int pressed = key_poll(&keys, &ev) ? ev.keys : 0;
+        if (pressed & 0b0001) { break; } // Sair com KEY0
 
         switch (state) {
             case STATE_START_SCREEN: {
-                fill_screen(BG_COLOR);
-                // Simula "SNAKE"
-                draw_grid_rect(GRID_WIDTH/2 - 2, GRID_HEIGHT/2 - 2, LIME_GREEN);
-                draw_grid_rect(GRID_WIDTH/2 - 1, GRID_HEIGHT/2 - 2, GREEN);
-                draw_grid_rect(GRID_WIDTH/2, GRID_HEIGHT/2 - 2, GREEN);
-                draw_grid_rect(GRID_WIDTH/2 + 1, GRID_HEIGHT/2 - 2, GREEN);
-                draw_grid_rect(GRID_WIDTH/2 + 2, GRID_HEIGHT/2 - 2, GREEN);
-                // Simula "Press KEY1/KEY2 to Start"
-                draw_grid_rect(GRID_WIDTH/2, GRID_HEIGHT/2, WHITE);
+                // A tela inicial é estática: desenha apenas ao entrar no estado
+                if (needs_full_redraw) {
+                    fill_screen(BG_COLOR);
+                    // Uma cobrinha de enfeite embaixo do título
+                    draw_grid_rect(GRID_WIDTH/2 - 2, GRID_HEIGHT/2 - 2, LIME_GREEN);
+                    draw_grid_rect(GRID_WIDTH/2 - 1, GRID_HEIGHT/2 - 2, GREEN);
+                    draw_grid_rect(GRID_WIDTH/2, GRID_HEIGHT/2 - 2, GREEN);
+                    draw_grid_rect(GRID_WIDTH/2 + 1, GRID_HEIGHT/2 - 2, GREEN);
+                    draw_grid_rect(GRID_WIDTH/2 + 2, GRID_HEIGHT/2 - 2, GREEN);
+                    text_clear(&text);
+                    text_print_center(&text, TEXT_TITLE_ROW, "S N A K E");
+                    text_print_center(&text, TEXT_HINT_ROW, "KEY1 ou KEY2 para jogar");
+                    needs_full_redraw = 0;
+                }
                 
-                if ((current_key_state & 0b0110) && !(prev_key_state & 0b0110)) { // KEY1 ou KEY2
+                if (pressed & 0b0110) { // KEY1 ou KEY2
                     init_game();
                 }
                 break;
             }
             case STATE_GAME_RUNNING: {
                 // Lógica de controle (virar esquerda/direita com detecção de borda)
-                int key1_pressed = (current_key_state & 0b0010) && !(prev_key_state & 0b0010);
-                int key2_pressed = (current_key_state & 0b0100) && !(prev_key_state & 0b0100);
+                int key1_pressed = pressed & 0b0010;
+                int key2_pressed = pressed & 0b0100;
 
                 if (key1_pressed) { // Virar à esquerda (não pode inverter direção)
                     if (direction != DOWN && direction != UP) direction = (direction - 1 + 4) % 4; // Evita erro lógico de direção
@@ -278,35 +468,49 @@ int main() {
                 update_game_state();
                 // Apenas desenha se o jogo não acabou nesta iteração
                 if (state == STATE_GAME_RUNNING) {
-                    draw_game_elements();
+                    if (needs_full_redraw) {
+                        draw_game_elements();
+                        needs_full_redraw = 0;
+                    } else {
+                        draw_game_changes();
+                    }
+                    text_printf(&text, 1, TEXT_SCORE_ROW, "PONTOS %d", score);
                 }
                 break;
             }
             case STATE_GAME_OVER: {
-                 // Fundo da mensagem
-                for(int i=0; i<5; i++) for(int j=0; j<12; j++) draw_grid_rect(GRID_WIDTH/2 - 6+j, GRID_HEIGHT/2-2+i, TEXT_BG_COLOR);
-                // "GAME OVER"
-                draw_grid_rect(GRID_WIDTH/2 - 4, GRID_HEIGHT/2-1, RED);
-                draw_grid_rect(GRID_WIDTH/2 - 2, GRID_HEIGHT/2-1, RED);
-                draw_grid_rect(GRID_WIDTH/2, GRID_HEIGHT/2-1, RED);
-                draw_grid_rect(GRID_WIDTH/2 + 2, GRID_HEIGHT/2-1, RED);
-                draw_grid_rect(GRID_WIDTH/2 + 4, GRID_HEIGHT/2-1, RED);
-
-                printf("FIM DE JOGO! Pontuacao final: %d. Pressione KEY1 ou KEY2 para jogar novamente.\n", score);
-                
+                if (needs_full_redraw) {
+                    // Fundo da mensagem (pixels) e o texto por cima (buffer de caracteres)
+                    for(int i=0; i<5; i++) for(int j=0; j<12; j++) draw_grid_rect(GRID_WIDTH/2 - 6+j, GRID_HEIGHT/2-2+i, TEXT_BG_COLOR);
+                    text_print_center(&text, TEXT_OVER_ROW, "GAME OVER");
+                    char final_score[32];
+                    snprintf(final_score, sizeof(final_score), "PONTOS %d", score);
+                    text_print_center(&text, TEXT_OVER_ROW + 3, final_score);
+                    text_print_center(&text, TEXT_OVER_ROW + 6, "KEY1 ou KEY2");
+
+                    printf("FIM DE JOGO! Pontuacao final: %d. Pressione KEY1 ou KEY2 para jogar novamente.\n", score);
+                    needs_full_redraw = 0;
+                }
+
                 // Espera um pressionar de tecla para reiniciar
-                if ((current_key_state & 0b0110) && !(prev_key_state & 0b0110)) {
-                    state = STATE_START_SCREEN;
+                if (pressed & 0b0110) {
+                    set_state(STATE_START_SCREEN);
                 }
                 break;
             }
         }
 
-        prev_key_state = current_key_state;
-        // A velocidade aumenta conforme o score (diminuindo o delay)
-        int current_delay = INITIAL_SPEED_DELAY - (score * 200);
-        if (current_delay < 40000) current_delay = 40000; // Limite máximo de velocidade
-        usleep(current_delay);
+        if (state == STATE_GAME_RUNNING) {
+            // A velocidade aumenta conforme o score (diminuindo o delay)
+            int current_delay = INITIAL_SPEED_DELAY - (score * 200);
+            if (current_delay < 40000) current_delay = 40000; // Limite máximo de velocidade
+            hud_frame_end(&hud);
+            usleep(current_delay);
+        } else if (!needs_full_redraw) {
+            // Telas paradas: dorme até o próximo clique (a espera não entra na média)
+            key_wait(&keys, -1);
+            hud_restart(&hud);
+        }
     }
     
     return 0; // atexit() cuidará da limpeza
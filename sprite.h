@@ -0,0 +1,226 @@
+#ifndef SPRITE_H
+#define SPRITE_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "blit.h"
+
+// =================================================================================
+// --- ATLAS DE SPRITES COM RLE ---
+// =================================================================================
+// Cada sprite é guardado já separado em trechos opacos: para cada linha, a
+// lista de spans (coluna inicial, comprimento) e os pixels desses spans, em
+// sequência, num vetor único do atlas. A parte transparente (cor-chave) não
+// ocupa memória e não custa nada no desenho: o blitter pula direto para o
+// próximo span e copia cada um inteiro (memcpy na memória comum, ou
+// blit_store_row() no framebuffer). O recorte é feito por linha e por span,
+// nunca por pixel.
+//
+// Vários sprites podem ir numa chamada só (sprite_draw_batch), que devolve o
+// retângulo que contém todos, para um único blit_present() por quadro.
+//
+// Uso: sprite_atlas_init(&atlas); id = sprite_add(&atlas, pixels, stride, w,
+// h, chave) a partir de um desenho RGB565 (de primitivas ou de img_draw());
+// sprite_draw(&atlas, id, &superficie, x, y) ou sprite_draw_device() direto
+// na VGA; sprite_atlas_free(&atlas) ao sair.
+
+typedef struct {
+    uint16_t x, len;            // Colunas [x, x + len) da linha do sprite
+    uint32_t pixel;             // Primeiro pixel do span no vetor de pixels
+} SpriteSpan;
+
+typedef struct {
+    uint32_t span;              // Primeiro span da linha
+    uint32_t count;             // Spans na linha (0 = linha transparente)
+} SpriteRow;
+
+typedef struct {
+    int width, height;
+    uint32_t row;               // Primeira linha no vetor de linhas
+} SpriteInfo;
+
+typedef struct {
+    SpriteInfo *sprites;
+    SpriteRow *rows;
+    SpriteSpan *spans;
+    uint16_t *pixels;           // Só os pixels opacos
+    int sprite_count;
+    uint32_t sprite_cap;
+    uint32_t row_count, row_cap;
+    uint32_t span_count, span_cap;
+    uint32_t pixel_count, pixel_cap;
+} SpriteAtlas;
+
+typedef struct {
+    int id, x, y;               // Canto superior esquerdo do sprite
+} SpriteDraw;
+
+static inline void sprite_atlas_init(SpriteAtlas *atlas) {
+    memset(atlas, 0, sizeof(*atlas));
+}
+
+static inline void sprite_atlas_free(SpriteAtlas *atlas) {
+    free(atlas->sprites);
+    free(atlas->rows);
+    free(atlas->spans);
+    free(atlas->pixels);
+    memset(atlas, 0, sizeof(*atlas));
+}
+
+// Garante espaço para 'needed' elementos, dobrando a capacidade
+static inline int sprite_reserve(void **data, uint32_t *cap, uint32_t needed, size_t size) {
+    if (needed <= *cap) return 0;
+    uint32_t new_cap = *cap ? *cap : 64;
+    while (new_cap < needed) new_cap *= 2;
+    void *grown = realloc(*data, (size_t)new_cap * size);
+    if (grown == NULL) return -1;
+    *data = grown;
+    *cap = new_cap;
+    return 0;
+}
+
+/**
+ * @brief Codifica um sprite w x h (RGB565, 'stride' pixels por linha) no atlas.
+ * Pixels iguais a 'key' são transparentes.
+ * @return Índice do sprite, ou -1 sem memória.
+ */
+static inline int sprite_add(SpriteAtlas *atlas, const uint16_t *pixels, int stride, int w, int h, uint16_t key) {
+    if (w <= 0 || h <= 0 || w > 0xFFFF ||
+        sprite_reserve((void **)&atlas->sprites, &atlas->sprite_cap, atlas->sprite_count + 1, sizeof(SpriteInfo)) != 0 ||
+        sprite_reserve((void **)&atlas->rows, &atlas->row_cap, atlas->row_count + h, sizeof(SpriteRow)) != 0) {
+        return -1;
+    }
+    SpriteInfo *info = &atlas->sprites[atlas->sprite_count];
+    info->width = w;
+    info->height = h;
+    info->row = atlas->row_count;
+
+    for (int y = 0; y < h; y++) {
+        const uint16_t *line = pixels + (long)y * stride;
+        SpriteRow *row = &atlas->rows[atlas->row_count + y];
+        row->span = atlas->span_count;
+        row->count = 0;
+        int x = 0;
+        while (x < w) {
+            while (x < w && line[x] == key) x++;
+            if (x == w) break;
+            int start = x;
+            while (x < w && line[x] != key) x++;
+            if (sprite_reserve((void **)&atlas->spans, &atlas->span_cap, atlas->span_count + 1, sizeof(SpriteSpan)) != 0 ||
+                sprite_reserve((void **)&atlas->pixels, &atlas->pixel_cap, atlas->pixel_count + (x - start), sizeof(uint16_t)) != 0) {
+                return -1;
+            }
+            atlas->spans[atlas->span_count++] = (SpriteSpan){ (uint16_t)start, (uint16_t)(x - start), atlas->pixel_count };
+            memcpy(atlas->pixels + atlas->pixel_count, line + start, (x - start) * sizeof(uint16_t));
+            atlas->pixel_count += x - start;
+            row->count++;
+        }
+    }
+    atlas->row_count += h;
+    return atlas->sprite_count++;
+}
+
+// Cópia de um span: até 32 pixels, dois blocos de tamanho fixo (início e fim,
+// sobrepostos se preciso) em vez de um laço, que o compilador transformaria
+// em "rep movs" ou numa chamada a memcpy() com custo fixo alto por span
+static inline void sprite_copy_span(uint16_t *dst, const uint16_t *src, int n) {
+    uint8_t head[32], tail[32];
+    if (n > 32) {
+        memcpy(dst, src, n * sizeof(uint16_t));
+    } else if (n >= 16) {
+        memcpy(head, src, 32);
+        memcpy(tail, src + n - 16, 32);
+        memcpy(dst, head, 32);
+        memcpy(dst + n - 16, tail, 32);
+    } else if (n >= 8) {
+        memcpy(head, src, 16);
+        memcpy(tail, src + n - 8, 16);
+        memcpy(dst, head, 16);
+        memcpy(dst + n - 8, tail, 16);
+    } else if (n >= 4) {
+        memcpy(head, src, 8);
+        memcpy(tail, src + n - 4, 8);
+        memcpy(dst, head, 8);
+        memcpy(dst + n - 4, tail, 8);
+    } else if (n >= 2) {
+        memcpy(head, src, 4);
+        memcpy(tail, src + n - 2, 4);
+        memcpy(dst, head, 4);
+        memcpy(dst + n - 2, tail, 4);
+    } else if (n == 1) {
+        *dst = *src;
+    }
+}
+
+// Núcleo comum: 'cached' (memória comum) ou 'device' (framebuffer), um dos dois
+static inline int sprite_draw_to(const SpriteAtlas *atlas, int id, uint16_t *cached, volatile uint16_t *device,
+                                 int stride, int width, int height, int x, int y) {
+    if (id < 0 || id >= atlas->sprite_count) return 0;
+    const SpriteInfo *info = &atlas->sprites[id];
+    int first = y < 0 ? -y : 0;
+    int last = y + info->height > height ? height - y : info->height;
+    if (x >= width || x + info->width <= 0) return 0;
+
+    int written = 0;
+    for (int row = first; row < last; row++) {
+        const SpriteRow *r = &atlas->rows[info->row + row];
+        const SpriteSpan *span = &atlas->spans[r->span];
+        long line = (long)(y + row) * stride;
+        for (uint32_t i = 0; i < r->count; i++, span++) {
+            int x0 = x + span->x, x1 = x0 + span->len;
+            const uint16_t *src = atlas->pixels + span->pixel;
+            if (x0 < 0) { src -= x0; x0 = 0; }
+            if (x1 > width) x1 = width;
+            if (x0 >= x1) continue;
+            if (cached != NULL) sprite_copy_span(cached + line + x0, src, x1 - x0);
+            else blit_store_row(device + line + x0, src, x1 - x0);
+            written += x1 - x0;
+        }
+    }
+    return written;
+}
+
+// Desenha o sprite com o canto em (x, y) numa superfície em memória comum
+static inline int sprite_draw(const SpriteAtlas *atlas, int id, BlitSurface *surface, int x, int y) {
+    return sprite_draw_to(atlas, id, surface->pixels, NULL, surface->stride, surface->width, surface->height, x, y);
+}
+
+// Desenha direto no framebuffer (só escritas, alinhadas a 64 bits quando possível)
+static inline int sprite_draw_device(const SpriteAtlas *atlas, int id, volatile uint16_t *device, int stride,
+                                     int width, int height, int x, int y) {
+    return sprite_draw_to(atlas, id, NULL, device, stride, width, height, x, y);
+}
+
+/**
+ * @brief Desenha 'count' sprites, na ordem, numa superfície em memória comum.
+ * @param bounds Recebe o retângulo (recortado) que contém todos (pode ser NULL).
+ * @return Pixels escritos.
+ */
+static inline int sprite_draw_batch(const SpriteAtlas *atlas, const SpriteDraw *draws, int count,
+                                    BlitSurface *surface, BlitRect *bounds) {
+    int written = 0;
+    int x0 = surface->width, y0 = surface->height, x1 = 0, y1 = 0;
+    for (int i = 0; i < count; i++) {
+        const SpriteDraw *d = &draws[i];
+        if (d->id < 0 || d->id >= atlas->sprite_count) continue;
+        const SpriteInfo *info = &atlas->sprites[d->id];
+        int drawn = sprite_draw(atlas, d->id, surface, d->x, d->y);
+        if (drawn == 0) continue;
+        written += drawn;
+        if (d->x < x0) x0 = d->x;
+        if (d->y < y0) y0 = d->y;
+        if (d->x + info->width > x1) x1 = d->x + info->width;
+        if (d->y + info->height > y1) y1 = d->y + info->height;
+    }
+    if (bounds != NULL) {
+        if (x0 < 0) x0 = 0;
+        if (y0 < 0) y0 = 0;
+        if (x1 > surface->width) x1 = surface->width;
+        if (y1 > surface->height) y1 = surface->height;
+        *bounds = written > 0 ? (BlitRect){ x0, y0, x1 - x0, y1 - y0 } : (BlitRect){ 0, 0, 0, 0 };
+    }
+    return written;
+}
+
+#endif
@@ -1,57 +1,101 @@
+#define HW_BAREMETAL // Sem sistema operacional: endereços físicos direto (hardware.h)
 #include <stdio.h>
+#include "jtag_uart.h"
 
-#define IO_JTAG_UART (*(volatile unsigned int *)0xFF201000)
-
-// Lê um caractere da JTAG_UART com polling
-char read_char() {
-    unsigned int data;
-    do {
-        data = IO_JTAG_UART;
-    } while ((data & 0x8000) == 0); // Espera até bit 15 estar setado (dado valido)
-
-    char c = data & 0xFF;
-
-    // Apenas caracteres ASCII imprimiveis
-    if (c >= 32 && c <= 126) {
-        putchar(c);        // Ecoa o caractere
-        fflush(stdout);    // Forca exibir imediatamente
-    } else if (c == '\r' || c == '\n') {
-        putchar('\n');
-    } else if (c == 8 || c == 127) {
-        printf("\b \b");   // Backspace
+// Lê uma linha com eco e backspace simples. A FIFO da JTAG_UART é esvaziada
+// em rajadas para o buffer de recepção (ver jtag_uart.h).
+void read_line(char *buffer, int max_len) {
+    static UartLine line;
+    while (!uart_line_poll(&line, buffer, max_len)) {
+        // Nada pendente: continua o polling
     }
+}
+
+#ifdef UART_BENCH
+// =================================================================================
+// --- BENCHMARK DE TRANSMISSÃO (compilar com -DUART_BENCH) ---
+// =================================================================================
+// Compara o envio antigo (putchar + fflush por caractere) com o buffer de
+// transmissão de jtag_uart.h, medindo com o timer privado do Cortex-A9.
+#define MPCORE_TIMER_BASE 0xFFFEC600
+#define MPCORE_TIMER_LOAD    (*(volatile unsigned int *)(MPCORE_TIMER_BASE + 0x0))
+#define MPCORE_TIMER_COUNTER (*(volatile unsigned int *)(MPCORE_TIMER_BASE + 0x4))
+#define MPCORE_TIMER_CONTROL (*(volatile unsigned int *)(MPCORE_TIMER_BASE + 0x8))
+#define MPCORE_TIMER_HZ      200000000u
+#define BENCH_BYTES          4096
+#define BENCH_ECHOES         256
 
-    return c;
+// O timer conta para baixo; a subtração sem sinal trata o recarregamento
+unsigned int timer_now() {
+    return MPCORE_TIMER_COUNTER;
 }
 
-// Lê uma linha com eco e backspace simples
-void read_line(char *buffer, int max_len) {
-    int i = 0;
-    while (i < max_len - 1) {
-        char c = read_char();
-
-        if (c == '\r' || c == '\n') {
-            break;
-        } else if ((c == 8 || c == 127) && i > 0) {
-            i--;
-        } else if (c >= 32 && c <= 126) {
-            buffer[i++] = c;
-        }
+unsigned int ticks_since(unsigned int start) {
+    return start - MPCORE_TIMER_COUNTER;
+}
+
+void run_benchmark() {
+    const char *pattern = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ.\n";
+    int pattern_len = 64;
+    unsigned int start, old_ticks, new_ticks, old_echo, new_echo;
+
+    MPCORE_TIMER_LOAD = 0xFFFFFFFF;
+    MPCORE_TIMER_CONTROL = 0x3; // Habilitado, recarga automática, sem prescaler
+
+    // 1. Vazão: forma antiga, um putchar + fflush por caractere
+    start = timer_now();
+    for (int i = 0; i < BENCH_BYTES; i++) {
+        putchar(pattern[i % pattern_len]);
+        fflush(stdout);
     }
-    buffer[i] = '\0';
+    old_ticks = ticks_since(start);
+
+    // 2. Vazão: buffer de transmissão em rajadas de WSPACE
+    start = timer_now();
+    for (int i = 0; i < BENCH_BYTES; i++) {
+        uart_putc(pattern[i % pattern_len]);
+    }
+    uart_flush();
+    new_ticks = ticks_since(start);
+
+    // 3. Latência de eco: tempo até o caractere chegar à FIFO de transmissão
+    start = timer_now();
+    for (int i = 0; i < BENCH_ECHOES; i++) {
+        putchar('.');
+        fflush(stdout);
+    }
+    old_echo = ticks_since(start);
+    start = timer_now();
+    for (int i = 0; i < BENCH_ECHOES; i++) {
+        uart_putc('.');
+        uart_poll_tx();
+    }
+    uart_flush();
+    new_echo = ticks_since(start);
+
+    uart_printf("\n%-10s %14s %16s\n", "envio", "bytes/s", "eco (us/char)");
+    uart_printf("%-10s %14u %16u\n", "putchar", (unsigned int)((unsigned long long)BENCH_BYTES * MPCORE_TIMER_HZ / old_ticks),
+                (unsigned int)((unsigned long long)old_echo * 1000000u / MPCORE_TIMER_HZ / BENCH_ECHOES));
+    uart_printf("%-10s %14u %16u\n", "buffer TX", (unsigned int)((unsigned long long)BENCH_BYTES * MPCORE_TIMER_HZ / new_ticks),
+                (unsigned int)((unsigned long long)new_echo * 1000000u / MPCORE_TIMER_HZ / BENCH_ECHOES));
 }
+#endif
 
 int main() {
     char input[100];
 
-    printf("Digite algo e pressione Enter (somente letras simples):\n");
+#ifdef UART_BENCH
+    run_benchmark();
+#endif
+
+    uart_puts("Digite algo e pressione Enter (somente letras simples):\n");
 
     while (1) {
-        printf("> ");
-        fflush(stdout);
+        uart_puts("> ");
+        uart_flush();
 
         read_line(input, 100);
-        printf("Voce digitou: %s\n", input);
+        uart_printf("Voce digitou: %s\n", input);
     }
 
     return 0;
@@ -0,0 +1,120 @@
+#ifndef TEXT_OVERLAY_H
+#define TEXT_OVERLAY_H
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include "hardware.h"
+
+// =================================================================================
+// --- TEXTO NO BUFFER DE CARACTERES DA VGA ---
+// =================================================================================
+// A VGA da DE1-SoC sobrepõe à imagem um buffer de 80x60 caracteres (cada um
+// ocupa 4x4 pixels da tela de 320x240): escrever um texto é gravar um byte
+// ASCII por letra, sem tocar no framebuffer nem redesenhar o que está por
+// baixo. Espaço = transparente.
+//
+// Como no hex_display.h, o módulo guarda uma sombra do que está no buffer e
+// só escreve os caracteres que mudaram: reescrever o placar a cada quadro
+// custa um ou dois bytes quando um dígito muda e nada quando não muda.
+//
+// Com base NULL (ex: jogo desenhando numa superfície do compositor) todas as
+// chamadas viram no-ops. Com -DHW_SIM o buffer é memória comum e text_dump()
+// mostra o conteúdo, para testar fora da placa.
+//
+// Uso: text_init(&text, hw_charbuffer()) depois de hw_init(); text_print(),
+// text_printf(), text_print_right() ou text_print_center() em (coluna, linha);
+// text_clear_line()/text_clear() para apagar; text_clear() ao sair, senão o
+// texto continua na tela depois que o programa termina.
+#define TEXT_COLS HW_CHAR_COLS
+#define TEXT_ROWS HW_CHAR_ROWS
+
+typedef struct {
+    volatile uint8_t *chars;            // Buffer de caracteres (NULL = desligado)
+    uint8_t shadow[TEXT_ROWS][TEXT_COLS];
+    unsigned long writes;               // Bytes escritos no buffer
+} TextOverlay;
+
+static inline void text_put(TextOverlay *t, int col, int row, char c) {
+    if (t->chars == NULL || col < 0 || col >= TEXT_COLS || row < 0 || row >= TEXT_ROWS) return;
+    if (t->shadow[row][col] == (uint8_t)c) return;
+    t->chars[row * HW_CHAR_STRIDE + col] = (uint8_t)c;
+    t->shadow[row][col] = (uint8_t)c;
+    t->writes++;
+}
+
+// Apaga n caracteres a partir de (col, row)
+static inline void text_clear_span(TextOverlay *t, int col, int row, int n) {
+    for (int i = 0; i < n; i++) text_put(t, col + i, row, ' ');
+}
+
+static inline void text_clear_line(TextOverlay *t, int row) {
+    text_clear_span(t, 0, row, TEXT_COLS);
+}
+
+static inline void text_clear(TextOverlay *t) {
+    for (int row = 0; row < TEXT_ROWS; row++) text_clear_line(t, row);
+}
+
+static inline void text_init(TextOverlay *t, volatile uint8_t *chars) {
+    t->chars = chars;
+    t->writes = 0;
+    if (chars == NULL) return;
+    // O buffer pode ter sobras de outro programa: escreve tudo uma vez
+    for (int row = 0; row < TEXT_ROWS; row++) {
+        for (int col = 0; col < TEXT_COLS; col++) {
+            chars[row * HW_CHAR_STRIDE + col] = ' ';
+            t->shadow[row][col] = ' ';
+        }
+    }
+}
+
+/**
+ * @brief Escreve 's' a partir de (col, row), cortando o que passar das bordas.
+ * @return Colunas ocupadas pelo texto (visíveis ou não).
+ */
+static inline int text_print(TextOverlay *t, int col, int row, const char *s) {
+    int n = 0;
+    for (; s[n] != '\0' && s[n] != '\n'; n++) text_put(t, col + n, row, s[n]);
+    return n;
+}
+
+static inline int text_printf(TextOverlay *t, int col, int row, const char *fmt, ...) {
+    char line[TEXT_COLS + 1];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    return text_print(t, col, row, line);
+}
+
+// Texto terminando antes da coluna 'end' (alinhado à direita)
+static inline int text_print_right(TextOverlay *t, int end, int row, const char *s) {
+    int n = (int)strcspn(s, "\n");
+    return text_print(t, end - n, row, s);
+}
+
+static inline int text_print_center(TextOverlay *t, int row, const char *s) {
+    int n = (int)strcspn(s, "\n");
+    return text_print(t, (TEXT_COLS - n) / 2, row, s);
+}
+
+// Linhas não vazias do buffer (lidas do próprio buffer, não da sombra)
+static inline void text_dump(const TextOverlay *t, FILE *out) {
+    if (t->chars == NULL) return;
+    for (int row = 0; row < TEXT_ROWS; row++) {
+        char line[TEXT_COLS + 1];
+        int last = -1;
+        for (int col = 0; col < TEXT_COLS; col++) {
+            uint8_t c = t->chars[row * HW_CHAR_STRIDE + col];
+            line[col] = (c >= 32 && c < 127) ? (char)c : ' ';
+            if (line[col] != ' ') last = col;
+        }
+        if (last < 0) continue;
+        line[last + 1] = '\0';
+        fprintf(out, "%2d|%s\n", row, line);
+    }
+}
+
+#endif
@@ -1,3 +1,4 @@
+#define HW_BAREMETAL // Sem sistema operacional: endereços físicos direto (hardware.h)
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -5,12 +6,14 @@
 #include <math.h>
 #include <stdint.h>  // Para uint16_t
 
-// Definições da interface JTAG_UART (entrada/saída via terminal)
-#define IO_JTAG_UART (*(volatile unsigned int *)0xFF201000)
+// Framebuffer e registradores da DE1-SoC
+#include "hardware.h"
+// Interface JTAG_UART (entrada/saída via terminal)
+#include "jtag_uart.h"
+// Quadros binários compactos, aceitos junto com os comandos de texto
+#include "draw_protocol.h"
 
-// Base da memória VGA
-#define VGA_BASE 0xC8000000
-#define SCREEN_WIDTH 512         // Largura total da tela
+// Área visível da VGA (o stride de 512 pixels está em hardware.h)
 #define VISIBLE_WIDTH 320        // Largura visível
 #define VISIBLE_HEIGHT 240       // Altura visível
 
@@ -32,41 +35,16 @@
 #define NAVY    0x000F
 #define TEAL    0x0410
 
-// Ponteiro para a matriz de pixels na memória VGA
-uint16_t *ppix = (uint16_t *)VGA_BASE;
-
 // Cor atual para desenhar
 uint16_t current_color = WHITE;
 
-// Função para ler um caractere da UART (com polling)
-char read_char() {
-    unsigned int data;
-    do {
-        data = IO_JTAG_UART;
-    } while ((data & 0x8000) == 0); // Espera até que bit 15 indique dado disponível
-    return data & 0xFF; // Retorna os bits 7:0 (caractere)
-}
-
-// Função para ler uma linha de texto do terminal (com eco e suporte a backspace)
+// Função para ler uma linha de texto do terminal (com eco e suporte a backspace).
+// Os bytes chegam em rajadas pelo buffer de recepção de jtag_uart.h.
 void read_line(char *buffer, int max_len) {
-    int i = 0;
-    while (i < max_len - 1) {
-        char c = read_char();
-        if (c == '\r' || c == '\n') break;  // Enter finaliza
-        if ((c == 8 || c == 127)) {         // Backspace ou DEL
-            if (i > 0) {
-                i--;
-                printf("\b \b");            // Apaga no terminal
-                fflush(stdout);
-            }
-        } else if (c >= 32 && c <= 126) {   // Caracteres imprimíveis
-            buffer[i++] = c;
-            putchar(c);                    // Eco na tela
-            fflush(stdout);
-        }
+    static UartLine line;
+    while (!uart_line_poll(&line, buffer, max_len)) {
+        // Nada pendente: continua o polling
     }
-    buffer[i] = '\0';
-    putchar('\n');
 }
 
 // Converte uma string para letras maiúsculas
@@ -80,7 +58,7 @@ void to_upper(char *str) {
 // Define um pixel na tela com a cor atual
 void set_pix(int lin, int col) {
     if (lin < 0 || lin >= VISIBLE_HEIGHT || col < 0 || col >= VISIBLE_WIDTH) return;
-    ppix[lin * SCREEN_WIDTH + col] = current_color;
+    hw_framebuffer()[lin][col] = current_color;
 }
 
 // Algoritmo de Bresenham para desenhar uma linha
@@ -144,13 +122,14 @@ void fill_screen() {
 
 // Mostra o menu de opções para o usuário
 void print_menu() {
-    printf("\nMenu de opcoes:\n");
-    printf("1) COLOR - Define a cor atual\n");
-    printf("2) LINE  - Desenha uma linha\n");
-    printf("3) CIRC  - Desenha um circulo\n");
-    printf("4) RECT  - Desenha um retangulo vazado\n");
-    printf("5) TILE  - Desenha um retangulo cheio\n");
-    printf("6) FUNDO - Preenche a tela\n");
+    // Um único texto: vai para o buffer de transmissão e sai em rajadas
+    uart_puts("\nMenu de opcoes:\n"
+              "1) COLOR - Define a cor atual\n"
+              "2) LINE  - Desenha uma linha\n"
+              "3) CIRC  - Desenha um circulo\n"
+              "4) RECT  - Desenha um retangulo vazado\n"
+              "5) TILE  - Desenha um retangulo cheio\n"
+              "6) FUNDO - Preenche a tela\n");
 }
 
 // Define a cor atual com base no nome digitado
@@ -172,30 +151,71 @@ void set_color(char *color_name) {
     else if (strcmp(color_name, "NAVY") == 0) current_color = NAVY;
     else if (strcmp(color_name, "TEAL") == 0) current_color = TEAL;
     else {
-        printf("Entrada invalida\n");
+        uart_puts("Entrada invalida\n");
         return;
     }
-    printf("Cor definida como %s\n", color_name);
+    uart_printf("Cor definida como %s\n", color_name);
+}
+
+
+// Executa um comando do protocolo binário (coordenadas em x, y)
+void execute_binary(const DrawCommand *cmd) {
+    const int16_t *a = cmd->args;
+    switch (cmd->op) {
+        case PROTO_COLOR: current_color = (uint16_t)a[0]; break;
+        case PROTO_LINE:  draw_line(a[0], a[1], a[2], a[3]); break;
+        case PROTO_CIRC:  draw_circle(a[1], a[0], a[2]); break;
+        case PROTO_RECT:  draw_rect(a[1], a[0], a[3], a[2]); break;
+        case PROTO_TILE:  draw_tile(a[1], a[0], a[3], a[2]); break;
+        case PROTO_FILL:  fill_screen(); break;
+        default: break; // PROTO_QUIT não se aplica ao bare metal
+    }
 }
 
+// Espera o primeiro byte do próximo comando. Se for o byte mágico, lê e executa
+// um quadro binário e retorna 1; se for texto, não consome nada e retorna 0.
+int poll_binary_command() {
+    char c;
+    while (!uart_rx_peek(&c)) {
+        uart_poll_tx();
+    }
+    if ((unsigned char)c != PROTO_MAGIC) return 0;
+
+    ProtoDecoder decoder = { .len = 0 };
+    DrawCommand cmd;
+    int status = 0;
+    while (status == 0) {
+        if (uart_rx_pop(&c)) status = proto_feed(&decoder, (uint8_t)c, &cmd);
+    }
+    if (status > 0) execute_binary(&cmd);
+    return 1;
+}
 
 // Função principal
 int main() {
     char input[100];
+    int show_menu = 1;
 
-    printf("Sistema de desenho VGA - DE1-SoC\n");
+    uart_puts("Sistema de desenho VGA - DE1-SoC\n");
 
     while (1) {
-        print_menu();
-        printf("> ");
+        // O menu só é reexibido após comandos de texto
+        if (show_menu) {
+            print_menu();
+            uart_puts("> ");
+            show_menu = 0;
+        }
+        if (poll_binary_command()) continue;
+
+        show_menu = 1;
         read_line(input, 100);
         to_upper(input);
 
         // Opção COLOR
         if (strcmp(input, "1") == 0 || strcmp(input, "COLOR") == 0) {
-            printf("Formato (COLOR): <cor>\n");
-            printf("Cores: BLACK RED GREEN BLUE GRAY WHITE ");
-            printf("YELLOW CYAN MAGENTA ORANGE PURPLE BROWN PINK LIME NAVY TEAL\n> ");
+            uart_puts("Formato (COLOR): <cor>\n");
+            uart_puts("Cores: BLACK RED GREEN BLUE GRAY WHITE ");
+            uart_puts("YELLOW CYAN MAGENTA ORANGE PURPLE BROWN PINK LIME NAVY TEAL\n> ");
             read_line(input, 100);
             to_upper(input);
             set_color(input);
@@ -204,60 +224,60 @@ int main() {
         // Opção LINE
         else if (strcmp(input, "2") == 0 || strcmp(input, "LINE") == 0) {
             int y0, x0, y1, x1;
-            printf("Formato (LINE): lin0 col0 lin1 col1\n> ");
+            uart_puts("Formato (LINE): lin0 col0 lin1 col1\n> ");
             read_line(input, 100);
             if (sscanf(input, "%d %d %d %d", &y0, &x0, &y1, &x1) == 4) {
                 draw_line(x0, y0, x1, y1);
             } else {
-                printf("Entrada invalida\n");
+                uart_puts("Entrada invalida\n");
             }
         }
 
         // Opção CIRC
         else if (strcmp(input, "3") == 0 || strcmp(input, "CIRC") == 0) {
             int lin, col, r;
-            printf("Formato (CIRC): lin col raio\n> ");
+            uart_puts("Formato (CIRC): lin col raio\n> ");
             read_line(input, 100);
             if (sscanf(input, "%d %d %d", &lin, &col, &r) == 3) {
                 draw_circle(lin, col, r);
             } else {
-                printf("Entrada invalida\n");
+                uart_puts("Entrada invalida\n");
             }
         }
 
         // Opção RECT
         else if (strcmp(input, "4") == 0 || strcmp(input, "RECT") == 0) {
             int y0, x0, y1, x1;
-            printf("Formato (RECT): lin0 col0 lin1 col1\n> ");
+            uart_puts("Formato (RECT): lin0 col0 lin1 col1\n> ");
             read_line(input, 100);
             if (sscanf(input, "%d %d %d %d", &y0, &x0, &y1, &x1) == 4) {
                 draw_rect(y0, x0, y1, x1);
             } else {
-                printf("Entrada invalida\n");
+                uart_puts("Entrada invalida\n");
             }
         }
 
         // Opção TILE
         else if (strcmp(input, "5") == 0 || strcmp(input, "TILE") == 0) {
             int y0, x0, y1, x1;
-            printf("Formato (TILE): lin0 col0 lin1 col1\n> ");
+            uart_puts("Formato (TILE): lin0 col0 lin1 col1\n> ");
             read_line(input, 100);
             if (sscanf(input, "%d %d %d %d", &y0, &x0, &y1, &x1) == 4) {
                 draw_tile(y0, x0, y1, x1);
             } else {
-                printf("Entrada invalida\n");
+                uart_puts("Entrada invalida\n");
             }
         }
 
         // Opção FUNDO
         else if (strcmp(input, "6") == 0 || strcmp(input, "FUNDO") == 0) {
             fill_screen();
-            printf("Tela preenchida com a cor atual\n");
+            uart_puts("Tela preenchida com a cor atual\n");
         }
 
         // Entrada inválida
         else {
-            printf("Entrada invalida\n");
+            uart_puts("Entrada invalida\n");
         }
     }
 
@@ -1,14 +1,30 @@
+#define _GNU_SOURCE // accept4
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <ctype.h>
 #include <stdint.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <time.h>
+#include <math.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
+#include "hardware.h"
+#include "draw_protocol.h"
+#include "blit.h"
+#include "image.h"
 
 // --- Configurações da VGA ---
-#define FRAME_BASE      0xC8000000
 #define LWIDTH          512      // Largura completa da linha na memória (stride)
 #define VISIBLE_WIDTH   320      // Largura visível
 #define VISIBLE_HEIGHT  240      // Altura visível
@@ -33,53 +49,53 @@
 #define TEAL    0x0410
 
 // --- Variáveis Globais para acesso ao Hardware ---
-int mem_fd; 
 volatile uint16_t (*tela)[LWIDTH]; 
 uint16_t current_color = WHITE;
+// Cópia da área visível em memória comum (com cache). Toda escrita na tela
+// também vai para cá, e quem precisa ler pixels (FLOOD) lê daqui, nunca do
+// mapeamento O_SYNC, em que cada leitura é uma transação no barramento.
+uint16_t shadow[VISIBLE_HEIGHT][VISIBLE_WIDTH];
+
+// --- Modo batch ---
+#define BATCH_BLOCK_SIZE (64 * 1024) // Leitura de pipes em blocos grandes
+#define MAX_LINE         200
+int quiet = 0;                       // 1 = sem mensagens por comando (modo batch)
+unsigned long pixels_drawn = 0;      // Pixels escritos na tela (para o resumo)
 
 // --- Protótipos das funções para organização ---
-void set_color(const char *color_name);
+int set_color(const char *color_name);
 void fill_screen();
 void draw_circle(int xc, int yc, int r);
 void draw_tile(int x0, int y0, int x1, int y1);
 void draw_line(int x0, int y0, int x1, int y1);
 void draw_rect(int x0, int y0, int x1, int y1);
+void draw_polygon(const int *xs, const int *ys, int n);
+int flood_fill(int x, int y);
+int copy_region(int x0, int y0, int x1, int y1, int dx, int dy, BlitRect *dest);
+void move_region(int x0, int y0, int x1, int y1, int dx, int dy);
+int draw_image(const char *path, int x, int y, int dither, double *ms);
+void draw_gradient(int x0, int y0, int x1, int y1, uint32_t from, uint32_t to);
 
 
 // --- Funções de Inicialização e Limpeza ---
-void cleanup_vga() {
-    if (tela != NULL) {
-        munmap((void*)tela, LWIDTH * VISIBLE_HEIGHT * PIXEL_SIZE);
-    }
-    if (mem_fd != -1) {
-        close(mem_fd);
+// Lê a tela uma vez para a cópia em cache (o conteúdo anterior ao programa)
+void sync_shadow() {
+    for (int y = 0; y < VISIBLE_HEIGHT; y++) {
+        for (int x = 0; x < VISIBLE_WIDTH; x++) shadow[y][x] = tela[y][x];
     }
+}
+
+void cleanup_vga() {
+    hw_close();
     printf("\nRecursos da VGA liberados. Saindo.\n");
 }
 
 int init_vga() {
-    mem_fd = open("/dev/mem", O_RDWR | O_SYNC);
-    if (mem_fd == -1) {
-        perror("Erro ao abrir /dev/mem");
+    if (hw_init() != 0) {
         return -1;
     }
-
-    void *framebuffer_map = mmap(
-        NULL,
-        LWIDTH * VISIBLE_HEIGHT * PIXEL_SIZE,
-        PROT_READ | PROT_WRITE,
-        MAP_SHARED,
-        mem_fd,
-        FRAME_BASE
-    );
-
-    if (framebuffer_map == MAP_FAILED) {
-        perror("Erro ao mapear o framebuffer da VGA");
-        close(mem_fd);
-        return -1;
-    }
-    
-    tela = (volatile uint16_t (*)[LWIDTH]) framebuffer_map;
+    tela = hw_framebuffer();
+    sync_shadow();
     atexit(cleanup_vga);
     return 0;
 }
@@ -103,6 +119,8 @@ void to_upper(char *str) {
 void set_pix(int x, int y) {
     if (y < 0 || y >= VISIBLE_HEIGHT || x < 0 || x >= VISIBLE_WIDTH) return;
     tela[y][x] = current_color;
+    shadow[y][x] = current_color;
+    pixels_drawn++;
 }
 
 void draw_line(int x0, int y0, int x1, int y1) {
@@ -150,17 +168,331 @@ void draw_tile(int x0, int y0, int x1, int y1) {
     }
 }
 
+// =================================================================================
+// --- PREENCHIMENTO DE POLÍGONOS (TABELA DE ARESTAS) ---
+// =================================================================================
+// Cada aresta não horizontal entra numa tabela ordenada pela primeira linha;
+// a cada linha da tela as arestas ativas são ordenadas por x e preenchidas
+// aos pares (regra par-ímpar). O x de cada aresta avança só com somas
+// inteiras: parte inteira + resto (como no Bresenham), sem ponto flutuante.
+// As linhas são amostradas em y inteiro e cada aresta cobre [ymin, ymax);
+// numa linha, o span vai de ceil(x_esq) a ceil(x_dir) - 1. Assim polígonos
+// vizinhos que compartilham uma aresta não escrevem o mesmo pixel duas vezes.
+// O recorte é feito uma vez por aresta (início em y = 0) e uma vez por span.
+#define POLY_MAX_VERTICES 32
+#define POLY_COORD_LIMIT  32767 // Mesma faixa do protocolo binário (int16)
+
+typedef struct {
+    int ymin, ymax;     // Linhas cobertas: [ymin, ymax), já recortadas
+    int x;              // Parte inteira de x na linha atual (para baixo)
+    int err;            // Resto: x real = x + err / dy, com 0 <= err < dy
+    int dy;
+    int step, rem;      // Avanço de x por linha: step + rem / dy
+} PolyEdge;
+
+typedef void (*SpanFunc)(int y, int xa, int xb);
+
+static int floor_div(long long num, int den, long long *rest) {
+    long long q = num / den;
+    if (num % den != 0 && num < 0) q--;
+    *rest = num - q * den;
+    return (int)q;
+}
+
+static int clamp_coord(int v) {
+    return v < -POLY_COORD_LIMIT ? -POLY_COORD_LIMIT : (v > POLY_COORD_LIMIT ? POLY_COORD_LIMIT : v);
+}
+
+// Compara o x real de duas arestas (x + err / dy) sem dividir
+static int edge_before(const PolyEdge *a, const PolyEdge *b) {
+    if (a->x != b->x) return a->x < b->x;
+    return (long long)a->err * b->dy < (long long)b->err * a->dy;
+}
+
+/**
+ * @brief Percorre o polígono linha a linha e chama 'span' para cada trecho interno
+ * já recortado à área visível.
+ */
+void scan_polygon(const int *xs, const int *ys, int n, SpanFunc span) {
+    PolyEdge edges[POLY_MAX_VERTICES];
+    int count = 0;
+    if (n > POLY_MAX_VERTICES) n = POLY_MAX_VERTICES;
+
+    for (int i = 0; i < n; i++) {
+        int xa = clamp_coord(xs[i]), ya = clamp_coord(ys[i]);
+        int xb = clamp_coord(xs[(i + 1) % n]), yb = clamp_coord(ys[(i + 1) % n]);
+        if (ya == yb) continue; // Horizontal: não cruza nenhuma linha de amostragem
+        if (ya > yb) {
+            int t = xa; xa = xb; xb = t;
+            t = ya; ya = yb; yb = t;
+        }
+        if (yb <= 0 || ya >= VISIBLE_HEIGHT) continue;
+
+        PolyEdge e;
+        long long rest;
+        e.dy = yb - ya;
+        e.step = floor_div(xb - xa, e.dy, &rest);
+        e.rem = (int)rest;
+        e.ymin = ya < 0 ? 0 : ya;
+        e.ymax = yb > VISIBLE_HEIGHT ? VISIBLE_HEIGHT : yb;
+        // x na primeira linha visível, calculado direto (recorte no topo)
+        e.x = xa + floor_div((long long)(e.ymin - ya) * (xb - xa), e.dy, &rest);
+        e.err = (int)rest;
+
+        // Inserção ordenada por ymin
+        int j = count++;
+        while (j > 0 && edges[j - 1].ymin > e.ymin) {
+            edges[j] = edges[j - 1];
+            j--;
+        }
+        edges[j] = e;
+    }
+
+    PolyEdge *active[POLY_MAX_VERTICES];
+    int nactive = 0, next = 0;
+    int y = count > 0 ? edges[0].ymin : VISIBLE_HEIGHT;
+    while (y < VISIBLE_HEIGHT && (next < count || nactive > 0)) {
+        if (nactive == 0 && edges[next].ymin > y) y = edges[next].ymin;
+
+        // Retira as arestas que terminaram e acrescenta as que começam nesta linha
+        int kept = 0;
+        for (int i = 0; i < nactive; i++) {
+            if (active[i]->ymax > y) active[kept++] = active[i];
+        }
+        nactive = kept;
+        while (next < count && edges[next].ymin == y) active[nactive++] = &edges[next++];
+
+        // Ordem por x (inserção: de uma linha para a outra quase nada muda)
+        for (int i = 1; i < nactive; i++) {
+            PolyEdge *e = active[i];
+            int j = i;
+            while (j > 0 && edge_before(e, active[j - 1])) {
+                active[j] = active[j - 1];
+                j--;
+            }
+            active[j] = e;
+        }
+
+        for (int i = 0; i + 1 < nactive; i += 2) {
+            int left = active[i]->x + (active[i]->err > 0);               // ceil(x_esq)
+            int right = active[i + 1]->x + (active[i + 1]->err > 0) - 1;  // ceil(x_dir) - 1
+            if (left < 0) left = 0;
+            if (right >= VISIBLE_WIDTH) right = VISIBLE_WIDTH - 1;
+            if (left <= right) span(y, left, right);
+        }
+
+        for (int i = 0; i < nactive; i++) {
+            PolyEdge *e = active[i];
+            e->x += e->step;
+            e->err += e->rem;
+            if (e->err >= e->dy) {
+                e->x++;
+                e->err -= e->dy;
+            }
+        }
+        y++;
+    }
+}
+
+// Trecho horizontal já recortado: escrita sequencial na linha, sem testes por pixel
+void fill_span(int y, int xa, int xb) {
+    volatile uint16_t *row = tela[y];
+    uint16_t *copy = shadow[y];
+    uint16_t color = current_color;
+    for (int x = xa; x <= xb; x++) {
+        row[x] = color;
+        copy[x] = color;
+    }
+    pixels_drawn += xb - xa + 1;
+}
+
+void draw_polygon(const int *xs, const int *ys, int n) {
+    if (n >= 3) scan_polygon(xs, ys, n, fill_span);
+}
+
+void draw_triangle(int x0, int y0, int x1, int y1, int x2, int y2) {
+    int xs[3] = { x0, x1, x2 };
+    int ys[3] = { y0, y1, y2 };
+    draw_polygon(xs, ys, 3);
+}
+
+// =================================================================================
+// --- PREENCHIMENTO DE REGIÕES (FLOOD FILL POR SPANS) ---
+// =================================================================================
+// Pinta a região conexa (4-vizinhança) da cor do pixel inicial. A pilha
+// guarda trechos de linha a examinar, não pixels: ao tirar um trecho, cada
+// sequência de pixels da cor antiga é estendida até as bordas, pintada de
+// uma vez com fill_span() e gera no máximo dois trechos novos (linha de cima
+// e de baixo). Leituras só na cópia em cache.
+//
+// Limite da pilha: cada sequência pintada é um trecho máximo da cor antiga
+// numa linha, pintado uma única vez; uma linha tem no máximo
+// (VISIBLE_WIDTH + 1) / 2 trechos assim. Logo há no máximo 2 * 160 * 240 + 1
+// empilhamentos ao todo, e a pilha estática nunca transborda.
+#define FLOOD_STACK_SIZE (2 * ((VISIBLE_WIDTH + 1) / 2) * VISIBLE_HEIGHT + 1)
+
+typedef struct {
+    int16_t y, xl, xr;  // Trecho [xl, xr] da linha y a examinar
+} FloodSpan;
+
+FloodSpan flood_stack[FLOOD_STACK_SIZE];
+int flood_max_depth = 0;        // Maior profundidade da pilha no último FLOOD
+
+/**
+ * @brief Preenche a região que contém (x, y) com a cor atual.
+ * @return Pixels pintados (0 se o ponto está fora da tela ou já tem a cor atual).
+ */
+int flood_fill(int x, int y) {
+    if (y < 0 || y >= VISIBLE_HEIGHT || x < 0 || x >= VISIBLE_WIDTH) return 0;
+    uint16_t target = shadow[y][x];
+    if (target == current_color) return 0;
+
+    int top = 0, painted = 0;
+    flood_max_depth = 1;
+    flood_stack[top++] = (FloodSpan){ y, x, x };
+    while (top > 0) {
+        FloodSpan s = flood_stack[--top];
+        const uint16_t *row = shadow[s.y];
+        int px = s.xl;
+        while (px <= s.xr) {
+            if (row[px] != target) {
+                px++;
+                continue;
+            }
+            int left = px, right = px;
+            while (left > 0 && row[left - 1] == target) left--;
+            while (right < VISIBLE_WIDTH - 1 && row[right + 1] == target) right++;
+            fill_span(s.y, left, right);
+            painted += right - left + 1;
+            if (s.y > 0) flood_stack[top++] = (FloodSpan){ s.y - 1, left, right };
+            if (s.y < VISIBLE_HEIGHT - 1) flood_stack[top++] = (FloodSpan){ s.y + 1, left, right };
+            if (top > flood_max_depth) flood_max_depth = top;
+            px = right + 2; // right + 1 tem outra cor
+        }
+    }
+    return painted;
+}
+
+// =================================================================================
+// --- CÓPIA E MOVIMENTO DE REGIÕES ---
+// =================================================================================
+// A cópia é feita na cópia em cache da tela (blit.h: recorte único, memmove
+// por linha na ordem segura para sobreposição, ou um memmove só para rolar a
+// tela inteira) e depois só o retângulo de destino é escrito na VGA. Nada é
+// lido do framebuffer.
+
+/**
+ * @brief Copia a região [x0, x1] x [y0, y1] deslocada de (dx, dy).
+ * @param dest Recebe o retângulo escrito na tela (w = 0 se nada); pode ser NULL.
+ * @return Pixels copiados (depois do recorte).
+ */
+int copy_region(int x0, int y0, int x1, int y1, int dx, int dy, BlitRect *dest) {
+    int xmin = x0 < x1 ? x0 : x1, xmax = x0 > x1 ? x0 : x1;
+    int ymin = y0 < y1 ? y0 : y1, ymax = y0 > y1 ? y0 : y1;
+    BlitSurface screen = blit_surface(shadow, VISIBLE_WIDTH, VISIBLE_WIDTH, VISIBLE_HEIGHT);
+    BlitRect copied_rect = { 0, 0, 0, 0 };
+    int copied = blit_copy(&screen, xmin, ymin, xmax - xmin + 1, ymax - ymin + 1, xmin + dx, ymin + dy, &copied_rect);
+    if (copied > 0) {
+        blit_present(&screen, &tela[0][0], LWIDTH, &copied_rect);
+        pixels_drawn += copied;
+    } else {
+        copied_rect.w = copied_rect.h = 0;
+    }
+    if (dest != NULL) *dest = copied_rect;
+    return copied;
+}
+
+// Copia e pinta com a cor atual a parte da origem que o destino não cobriu
+void move_region(int x0, int y0, int x1, int y1, int dx, int dy) {
+    int xmin = x0 < x1 ? x0 : x1, xmax = x0 > x1 ? x0 : x1;
+    int ymin = y0 < y1 ? y0 : y1, ymax = y0 > y1 ? y0 : y1;
+    // Coberto é só o que a cópia escreveu de fato (recortado): o que veio de
+    // fora da tela não existe e também fica descoberto
+    BlitRect dest;
+    copy_region(xmin, ymin, xmax, ymax, dx, dy, &dest);
+
+    int left = xmin < 0 ? 0 : xmin, right = xmax >= VISIBLE_WIDTH ? VISIBLE_WIDTH - 1 : xmax;
+    int top = ymin < 0 ? 0 : ymin, bottom = ymax >= VISIBLE_HEIGHT ? VISIBLE_HEIGHT - 1 : ymax;
+    for (int y = top; y <= bottom && left <= right; y++) {
+        if (dest.w <= 0 || y < dest.y || y >= dest.y + dest.h) {
+            fill_span(y, left, right); // Linha fora do destino: toda descoberta
+            continue;
+        }
+        int covered_left = dest.x, covered_right = dest.x + dest.w - 1;
+        if (left < covered_left) fill_span(y, left, covered_left - 1 < right ? covered_left - 1 : right);
+        if (right > covered_right) fill_span(y, covered_right + 1 > left ? covered_right + 1 : left, right);
+    }
+}
+
+/**
+ * @brief Desenha um PPM/BMP com o canto em (x, y): converte direto na cópia em
+ * cache da tela e manda só o retângulo visível para a VGA.
+ * @param dither 1 para pontilhado ordenado, 0 para truncar os bits.
+ * @param ms Recebe o tempo total (abrir, converter, escrever e fechar).
+ * @return Pixels desenhados, ou -1 se a imagem não pôde ser aberta.
+ */
+int draw_image(const char *path, int x, int y, int dither, double *ms) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    Image img;
+    if (img_open(&img, path) != 0) return -1;
+    img.dither = dither;
+    BlitSurface screen = blit_surface(shadow, VISIBLE_WIDTH, VISIBLE_WIDTH, VISIBLE_HEIGHT);
+    BlitRect dest;
+    int drawn = img_draw(&img, &screen, x, y, &dest);
+    if (drawn > 0) blit_present(&screen, &tela[0][0], LWIDTH, &dest);
+    img_close(&img);
+    pixels_drawn += drawn;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (ms != NULL) *ms = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    return drawn;
+}
+
+/**
+ * @brief Degradê horizontal de 'from' (em x0) a 'to' (em x1), cores 0xRRGGBB,
+ * convertido com pontilhado ordenado para não aparecerem faixas.
+ */
+void draw_gradient(int x0, int y0, int x1, int y1, uint32_t from, uint32_t to) {
+    int xmin = x0 < x1 ? x0 : x1, xmax = x0 > x1 ? x0 : x1;
+    int ymin = y0 < y1 ? y0 : y1, ymax = y0 > y1 ? y0 : y1;
+    if (x0 > x1) {
+        uint32_t t = from; from = to; to = t;
+    }
+    int left = xmin < 0 ? 0 : xmin, right = xmax >= VISIBLE_WIDTH ? VISIBLE_WIDTH - 1 : xmax;
+    int top = ymin < 0 ? 0 : ymin, bottom = ymax >= VISIBLE_HEIGHT ? VISIBLE_HEIGHT - 1 : ymax;
+    if (left > right || top > bottom) return;
+
+    // Uma linha RGB888 serve para todas; só os limiares mudam de linha para linha
+    uint8_t row[VISIBLE_WIDTH * 3];
+    int span = xmax - xmin;
+    for (int x = left; x <= right; x++) {
+        for (int c = 0; c < 3; c++) {
+            int a = (from >> (16 - 8 * c)) & 0xFF, b = (to >> (16 - 8 * c)) & 0xFF;
+            row[3 * (x - left) + c] = span == 0 ? a : (uint8_t)(a + (b - a) * (x - xmin) / span);
+        }
+    }
+    for (int y = top; y <= bottom; y++) {
+        rgb565_dither_row(&shadow[y][left], row, right - left + 1, 0, left, y);
+    }
+    BlitSurface screen = blit_surface(shadow, VISIBLE_WIDTH, VISIBLE_WIDTH, VISIBLE_HEIGHT);
+    BlitRect dest = { left, top, right - left + 1, bottom - top + 1 };
+    blit_present(&screen, &tela[0][0], LWIDTH, &dest);
+    pixels_drawn += dest.w * dest.h;
+}
+
 void fill_screen() {
     uint16_t color = current_color;
     for (int y = 0; y < VISIBLE_HEIGHT; y++) {
         for (int x = 0; x < VISIBLE_WIDTH; x++) {
             tela[y][x] = color;
+            shadow[y][x] = color;
         }
     }
+    pixels_drawn += VISIBLE_WIDTH * VISIBLE_HEIGHT;
 }
 
 // --- Lógica Principal e Menu ---
-void set_color(const char *color_name) {
+int set_color(const char *color_name) {
     if (strcmp(color_name, "BLACK") == 0) current_color = BLACK;
     else if (strcmp(color_name, "RED") == 0) current_color = RED;
     else if (strcmp(color_name, "GREEN") == 0) current_color = GREEN;
@@ -178,10 +510,11 @@ void set_color(const char *color_name) {
     else if (strcmp(color_name, "NAVY") == 0) current_color = NAVY;
     else if (strcmp(color_name, "TEAL") == 0) current_color = TEAL;
     else {
-        printf("Cor '%s' invalida!\n", color_name);
-        return;
+        if (!quiet) printf("Cor '%s' invalida!\n", color_name);
+        return 0;
     }
-    printf("Cor definida como %s\n", color_name);
+    if (!quiet) printf("Cor definida como %s\n", color_name);
+    return 1;
 }
 
 void print_menu() {
@@ -194,6 +527,13 @@ void print_menu() {
     printf("5. TILE <x0 y0 x1 y1>   - Desenha retangulo preenchido\n");
     printf("6. FUNDO              - Preenche a tela\n");
     printf("7. SAIR               - Termina o programa\n");
+    printf("8. TRI <x0 y0 x1 y1 x2 y2> - Desenha triangulo preenchido\n");
+    printf("9. POLY <x0 y0 x1 y1 ...>  - Desenha poligono preenchido (3 a %d vertices)\n", POLY_MAX_VERTICES);
+    printf("10. FLOOD <x y>       - Preenche a regiao que contem o ponto\n");
+    printf("11. COPY <x0 y0 x1 y1 dx dy> - Copia a regiao deslocada de (dx, dy)\n");
+    printf("12. MOVE <x0 y0 x1 y1 dx dy> - Move a regiao (a origem fica com a cor atual)\n");
+    printf("13. IMG <arquivo x y> [TRUNC] - Desenha uma imagem PPM (P6) ou BMP de 24 bits\n");
+    printf("14. GRAD <x0 y0 x1 y1 RRGGBB RRGGBB> - Degrade horizontal entre duas cores\n");
 }
 
 void run_demo_sequence() {
@@ -235,13 +575,987 @@ void run_demo_sequence() {
 }
 
 
-int main() {
+/**
+ * @brief Interpreta e executa uma linha de comando (a linha é convertida para maiúsculas).
+ * @return 1 se executou, 0 se o comando era inválido, -1 para SAIR.
+ */
+int execute_command(char *input) {
+    char command[MAX_LINE], params[MAX_LINE];
+    char raw[MAX_LINE]; // Linha original: nomes de arquivo diferenciam maiúsculas
+
+    snprintf(raw, sizeof(raw), "%s", input);
+    to_upper(input);
+
+    // Limpa os buffers antes de parsear
+    command[0] = '\0';
+    params[0] = '\0';
+    sscanf(input, "%s %[^\n]", command, params);
+
+    if (strcmp(command, "1") == 0 || strcmp(command, "COLOR") == 0) {
+        return set_color(params);
+    } else if (strcmp(command, "2") == 0 || strcmp(command, "LINE") == 0) {
+        int x0, y0, x1, y1;
+        if (sscanf(params, "%d %d %d %d", &x0, &y0, &x1, &y1) == 4) {
+            draw_line(x0, y0, x1, y1);
+            return 1;
+        }
+        if (!quiet) printf("Formato invalido. Use: LINE x0 y0 x1 y1\n");
+    } else if (strcmp(command, "3") == 0 || strcmp(command, "CIRC") == 0) {
+        int xc, yc, r;
+        if (sscanf(params, "%d %d %d", &xc, &yc, &r) == 3) {
+            draw_circle(xc, yc, r);
+            return 1;
+        }
+        if (!quiet) printf("Formato invalido. Use: CIRC xc yc r\n");
+    } else if (strcmp(command, "4") == 0 || strcmp(command, "RECT") == 0) {
+        int x0, y0, x1, y1;
+        if (sscanf(params, "%d %d %d %d", &x0, &y0, &x1, &y1) == 4) {
+            draw_rect(x0, y0, x1, y1);
+            return 1;
+        }
+        if (!quiet) printf("Formato invalido. Use: RECT x0 y0 x1 y1\n");
+    } else if (strcmp(command, "5") == 0 || strcmp(command, "TILE") == 0) {
+        int x0, y0, x1, y1;
+        if (sscanf(params, "%d %d %d %d", &x0, &y0, &x1, &y1) == 4) {
+            draw_tile(x0, y0, x1, y1);
+            return 1;
+        }
+        if (!quiet) printf("Formato invalido. Use: TILE x0 y0 x1 y1\n");
+    } else if (strcmp(command, "6") == 0 || strcmp(command, "FUNDO") == 0) {
+        fill_screen();
+        if (!quiet) printf("Tela preenchida com a cor atual.\n");
+        return 1;
+    } else if (strcmp(command, "7") == 0 || strcmp(command, "SAIR") == 0) {
+        return -1;
+    } else if (strcmp(command, "8") == 0 || strcmp(command, "TRI") == 0) {
+        int x0, y0, x1, y1, x2, y2;
+        if (sscanf(params, "%d %d %d %d %d %d", &x0, &y0, &x1, &y1, &x2, &y2) == 6) {
+            draw_triangle(x0, y0, x1, y1, x2, y2);
+            return 1;
+        }
+        if (!quiet) printf("Formato invalido. Use: TRI x0 y0 x1 y1 x2 y2\n");
+    } else if (strcmp(command, "9") == 0 || strcmp(command, "POLY") == 0) {
+        int xs[POLY_MAX_VERTICES], ys[POLY_MAX_VERTICES];
+        int n = 0, used;
+        const char *p = params;
+        while (n < POLY_MAX_VERTICES && sscanf(p, "%d %d%n", &xs[n], &ys[n], &used) == 2) {
+            p += used;
+            n++;
+        }
+        if (n >= 3) {
+            draw_polygon(xs, ys, n);
+            return 1;
+        }
+        if (!quiet) printf("Formato invalido. Use: POLY x0 y0 x1 y1 x2 y2 ... (3 a %d vertices)\n", POLY_MAX_VERTICES);
+    } else if (strcmp(command, "10") == 0 || strcmp(command, "FLOOD") == 0) {
+        int x, y;
+        if (sscanf(params, "%d %d", &x, &y) == 2) {
+            int painted = flood_fill(x, y);
+            if (!quiet) printf("%d pixels preenchidos.\n", painted);
+            return 1;
+        }
+        if (!quiet) printf("Formato invalido. Use: FLOOD x y\n");
+    } else if (strcmp(command, "11") == 0 || strcmp(command, "COPY") == 0 ||
+               strcmp(command, "12") == 0 || strcmp(command, "MOVE") == 0) {
+        int move = strcmp(command, "12") == 0 || strcmp(command, "MOVE") == 0;
+        int x0, y0, x1, y1, dx, dy;
+        if (sscanf(params, "%d %d %d %d %d %d", &x0, &y0, &x1, &y1, &dx, &dy) == 6) {
+            if (move) move_region(x0, y0, x1, y1, dx, dy);
+            else copy_region(x0, y0, x1, y1, dx, dy, NULL);
+            return 1;
+        }
+        if (!quiet) printf("Formato invalido. Use: %s x0 y0 x1 y1 dx dy\n", move ? "MOVE" : "COPY");
+    } else if (strcmp(command, "13") == 0 || strcmp(command, "IMG") == 0) {
+        char path[MAX_LINE], mode[MAX_LINE] = "";
+        int x, y;
+        if (sscanf(raw, "%*s %s %d %d %s", path, &x, &y, mode) >= 3) {
+            // Pontilhado ordenado por padrão; TRUNC só descarta os bits
+            double ms;
+            int drawn = draw_image(path, x, y, strcasecmp(mode, "TRUNC") != 0, &ms);
+            if (drawn < 0) return 0;
+            if (!quiet) printf("Imagem desenhada: %d pixels em %.2f ms\n", drawn, ms);
+            return 1;
+        }
+        if (!quiet) printf("Formato invalido. Use: IMG arquivo x y [TRUNC]\n");
+    } else if (strcmp(command, "14") == 0 || strcmp(command, "GRAD") == 0) {
+        int x0, y0, x1, y1;
+        unsigned int from, to;
+        if (sscanf(params, "%d %d %d %d %x %x", &x0, &y0, &x1, &y1, &from, &to) == 6) {
+            draw_gradient(x0, y0, x1, y1, from & 0xFFFFFF, to & 0xFFFFFF);
+            return 1;
+        }
+        if (!quiet) printf("Formato invalido. Use: GRAD x0 y0 x1 y1 RRGGBB RRGGBB\n");
+    } else if (strlen(command) > 0) { // Evita msg de erro para entrada vazia
+        if (!quiet) printf("Comando desconhecido: %s\n", command);
+    } else {
+        return 1; // Linha vazia
+    }
+    return 0;
+}
+
+/**
+ * @brief Executa um comando do protocolo binário (ver draw_protocol.h).
+ * @return 1 se executou, -1 para SAIR.
+ */
+int execute_binary(const DrawCommand *cmd) {
+    const int16_t *a = cmd->args;
+    switch (cmd->op) {
+        case PROTO_COLOR: current_color = (uint16_t)a[0]; break;
+        case PROTO_LINE:  draw_line(a[0], a[1], a[2], a[3]); break;
+        case PROTO_CIRC:  draw_circle(a[0], a[1], a[2]); break;
+        case PROTO_RECT:  draw_rect(a[0], a[1], a[2], a[3]); break;
+        case PROTO_TILE:  draw_tile(a[0], a[1], a[2], a[3]); break;
+        case PROTO_FILL:  fill_screen(); break;
+        case PROTO_QUIT:  return -1;
+        case PROTO_TRI:   draw_triangle(a[0], a[1], a[2], a[3], a[4], a[5]); break;
+        case PROTO_FLOOD: flood_fill(a[0], a[1]); break;
+        case PROTO_COPY:  copy_region(a[0], a[1], a[2], a[3], a[4], a[5], NULL); break;
+        case PROTO_MOVE:  move_region(a[0], a[1], a[2], a[3], a[4], a[5]); break;
+    }
+    return 1;
+}
+
+// Lê e executa um quadro binário da entrada padrão (o byte mágico já foi lido)
+int read_binary_command() {
+    uint8_t frame[PROTO_MAX_FRAME];
+    frame[0] = PROTO_MAGIC;
+    int op = getchar();
+    if (op == EOF) return -1;
+    frame[1] = (uint8_t)op;
+    int count = proto_arg_count(frame[1]);
+    if (count < 0) {
+        if (!quiet) printf("Opcode binario invalido: 0x%02X\n", op);
+        return 0;
+    }
+    if (fread(frame + 2, 2, count, stdin) != (size_t)count) return -1;
+
+    DrawCommand cmd;
+    proto_decode(frame, 2 + 2 * count, &cmd);
+    return execute_binary(&cmd);
+}
+
+// =================================================================================
+// --- MODO BATCH ---
+// =================================================================================
+// Executa comandos de um arquivo ou pipe sem menu, prompt nem mensagens por
+// comando. Arquivos comuns são mapeados com mmap; pipes são lidos em blocos.
+typedef struct {
+    char line[MAX_LINE];    // Linha parcial entre dois blocos
+    int len;
+    int overflow;           // Linha passou de MAX_LINE: descartada até o '\n'
+    ProtoDecoder binary;    // Quadro binário parcial entre dois blocos
+    long commands;
+    long errors;
+    int finished;           // SAIR encontrado
+} BatchState;
+
+void batch_count(BatchState *batch, int status) {
+    if (status < 0) batch->finished = 1;
+    else if (status == 0) batch->errors++;
+    else batch->commands++;
+}
+
+void batch_run_line(BatchState *batch) {
+    if (batch->overflow) {
+        // Executar o começo de uma linha cortada poderia rodar outro comando válido
+        batch->overflow = 0;
+        batch->len = 0;
+        batch->errors++;
+        return;
+    }
+    if (batch->len > 0 && batch->line[batch->len - 1] == '\r') batch->len--;
+    batch->line[batch->len] = '\0';
+    batch->len = 0;
+    if (batch->line[0] == '\0') return; // Linha vazia
+    batch_count(batch, execute_command(batch->line));
+}
+
+// Separa um bloco em linhas de texto e quadros binários, guardando o pedaço
+// final para o próximo bloco
+void batch_feed(BatchState *batch, const char *data, size_t size) {
+    DrawCommand cmd;
+    while (size > 0 && !batch->finished) {
+        // Quadro binário: reconhecido pelo byte mágico no início de uma linha
+        if (batch->binary.len > 0 || (batch->len == 0 && (uint8_t)*data == PROTO_MAGIC)) {
+            if (batch->binary.len == 0) {
+                int used = proto_decode((const uint8_t *)data, size, &cmd);
+                if (used != 0) {
+                    if (used > 0) batch_count(batch, execute_binary(&cmd));
+                    else batch->errors++;
+                    used = used > 0 ? used : 2; // Opcode inválido: descarta mágico + opcode
+                    data += used;
+                    size -= used;
+                    continue;
+                }
+            }
+            // Quadro cortado no fim do bloco: monta byte a byte
+            int status = proto_feed(&batch->binary, (uint8_t)*data, &cmd);
+            data++;
+            size--;
+            if (status > 0) batch_count(batch, execute_binary(&cmd));
+            else if (status < 0) batch->errors++;
+            continue;
+        }
+
+        const char *newline = memchr(data, '\n', size);
+        size_t chunk = newline ? (size_t)(newline - data) : size;
+        size_t room = sizeof(batch->line) - 1 - batch->len;
+        if (chunk > room) batch->overflow = 1;
+        if (!batch->overflow) {
+            memcpy(batch->line + batch->len, data, chunk);
+            batch->len += chunk;
+        }
+        if (!newline) return;
+        batch_run_line(batch);
+        data += chunk + 1;
+        size -= chunk + 1;
+    }
+}
+
+int run_batch(const char *path) {
+    int fd = (strcmp(path, "-") == 0) ? STDIN_FILENO : open(path, O_RDONLY);
+    if (fd == -1) {
+        perror("Erro ao abrir o arquivo de comandos");
+        return 1;
+    }
+
+    BatchState batch;
+    memset(&batch, 0, sizeof(batch));
+    quiet = 1;
+    pixels_drawn = 0;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    struct stat info;
+    void *mapped = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    if (mapped != MAP_FAILED) {
+        madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+        batch_feed(&batch, (const char *)mapped, info.st_size);
+        munmap(mapped, info.st_size);
+    } else {
+        static char block[BATCH_BLOCK_SIZE];
+        ssize_t n;
+        while (!batch.finished && (n = read(fd, block, sizeof(block))) > 0) {
+            batch_feed(&batch, block, n);
+        }
+    }
+    if (!batch.finished && (batch.len > 0 || batch.overflow)) batch_run_line(&batch); // Última linha sem '\n'
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (fd != STDIN_FILENO) close(fd);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("Batch: %ld comandos (%ld invalidos) em %.3f s - %.0f comandos/s, %lu pixels desenhados\n",
+           batch.commands, batch.errors, seconds, seconds > 0 ? batch.commands / seconds : 0.0, pixels_drawn);
+    return 0;
+}
+
+// =================================================================================
+// --- BENCHMARK TEXTO x BINÁRIO ---
+// =================================================================================
+#define BENCH_COMMANDS 200000
+
+double run_bench_stream(const char *data, size_t size, long *commands) {
+    BatchState batch;
+    memset(&batch, 0, sizeof(batch));
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    batch_feed(&batch, data, size);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *commands = batch.commands;
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+// Gera a mesma sequência de comandos nas duas formas e mede comandos/s de cada uma
+void run_protocol_benchmark() {
+    static const char *names[] = { "LINE", "CIRC", "RECT", "TILE" };
+    static const uint8_t ops[] = { PROTO_LINE, PROTO_CIRC, PROTO_RECT, PROTO_TILE };
+    char *text = malloc(BENCH_COMMANDS * 32);
+    uint8_t *binary = malloc(BENCH_COMMANDS * PROTO_MAX_FRAME);
+    if (text == NULL || binary == NULL) {
+        perror("malloc");
+        return;
+    }
+
+    size_t text_size = 0, binary_size = 0;
+    srand(1);
+    for (int i = 0; i < BENCH_COMMANDS; i++) {
+        // Primitivas pequenas, para que o custo de interpretação apareça
+        int kind = rand() % 4;
+        int x = rand() % VISIBLE_WIDTH, y = rand() % VISIBLE_HEIGHT;
+        DrawCommand cmd = { ops[kind], { x, y, x + rand() % 16, y + rand() % 16 } };
+        if (kind == 1) cmd.args[2] = 1 + rand() % 8;
+        if (kind == 1) text_size += sprintf(text + text_size, "%s %d %d %d\n", names[kind], cmd.args[0], cmd.args[1], cmd.args[2]);
+        else text_size += sprintf(text + text_size, "%s %d %d %d %d\n", names[kind], cmd.args[0], cmd.args[1], cmd.args[2], cmd.args[3]);
+        binary_size += proto_encode(&cmd, binary + binary_size);
+    }
+
+    quiet = 1;
+    long text_commands, binary_commands;
+    double text_time = run_bench_stream(text, text_size, &text_commands);
+    double binary_time = run_bench_stream((const char *)binary, binary_size, &binary_commands);
+
+    printf("%-8s %10s %10s %14s %12s\n", "formato", "comandos", "bytes", "comandos/s", "bytes/cmd");
+    printf("%-8s %10ld %10zu %14.0f %12.1f\n", "texto", text_commands, text_size, text_commands / text_time, (double)text_size / text_commands);
+    printf("%-8s %10ld %10zu %14.0f %12.1f\n", "binario", binary_commands, binary_size, binary_commands / binary_time, (double)binary_size / binary_commands);
+    free(text);
+    free(binary);
+}
+
+// =================================================================================
+// --- BENCHMARK TRI x LINE ---
+// =================================================================================
+// Preenche os mesmos triângulos de duas formas: um comando TRI cada, ou um
+// LINE horizontal por linha do triângulo (o que um cliente teria de enviar
+// sem TRI). Os LINE são gerados pelo próprio rasterizador, então as duas
+// imagens devem sair idênticas; o benchmark confere isso.
+#define POLY_BENCH_SHAPES 2000
+
+char *poly_bench_text;          // Destino dos LINE gerados por bench_line_span()
+size_t poly_bench_size;
+
+void bench_line_span(int y, int xa, int xb) {
+    poly_bench_size += sprintf(poly_bench_text + poly_bench_size, "LINE %d %d %d %d\n", xa, y, xb, y);
+}
+
+void bench_clear_screen() {
+    for (int y = 0; y < VISIBLE_HEIGHT; y++) {
+        for (int x = 0; x < VISIBLE_WIDTH; x++) {
+            tela[y][x] = BLACK;
+            shadow[y][x] = BLACK;
+        }
+    }
+}
+
+void bench_snapshot(uint16_t *out) {
+    for (int y = 0; y < VISIBLE_HEIGHT; y++) {
+        for (int x = 0; x < VISIBLE_WIDTH; x++) out[y * VISIBLE_WIDTH + x] = tela[y][x];
+    }
+}
+
+void run_poly_benchmark() {
+    char *tri_text = malloc(POLY_BENCH_SHAPES * 48);
+    poly_bench_text = malloc((size_t)POLY_BENCH_SHAPES * VISIBLE_HEIGHT * 24);
+    uint16_t *tri_image = malloc(VISIBLE_WIDTH * VISIBLE_HEIGHT * sizeof(uint16_t));
+    uint16_t *line_image = malloc(VISIBLE_WIDTH * VISIBLE_HEIGHT * sizeof(uint16_t));
+    if (tri_text == NULL || poly_bench_text == NULL || tri_image == NULL || line_image == NULL) {
+        perror("malloc");
+        return;
+    }
+
+    // Triângulos de tamanhos variados, alguns saindo da tela; a cor muda a
+    // cada um para que a comparação das imagens pegue diferenças de ordem
+    static const char *colors[] = { "RED", "GREEN", "BLUE", "YELLOW", "CYAN", "MAGENTA", "ORANGE", "WHITE" };
+    size_t tri_size = 0;
+    poly_bench_size = 0;
+    srand(1);
+    for (int i = 0; i < POLY_BENCH_SHAPES; i++) {
+        int size = 8 + rand() % 160;
+        int cx = rand() % (VISIBLE_WIDTH + 40) - 20, cy = rand() % (VISIBLE_HEIGHT + 40) - 20;
+        int xs[3], ys[3];
+        for (int v = 0; v < 3; v++) {
+            xs[v] = cx + rand() % size - size / 2;
+            ys[v] = cy + rand() % size - size / 2;
+        }
+        const char *color = colors[i % 8];
+        tri_size += sprintf(tri_text + tri_size, "COLOR %s\nTRI %d %d %d %d %d %d\n", color, xs[0], ys[0], xs[1], ys[1], xs[2], ys[2]);
+        poly_bench_size += sprintf(poly_bench_text + poly_bench_size, "COLOR %s\n", color);
+        scan_polygon(xs, ys, 3, bench_line_span);
+    }
+
+    quiet = 1;
+    long tri_commands, line_commands;
+
+    bench_clear_screen();
+    pixels_drawn = 0;
+    double tri_time = run_bench_stream(tri_text, tri_size, &tri_commands);
+    unsigned long tri_pixels = pixels_drawn;
+    bench_snapshot(tri_image);
+
+    bench_clear_screen();
+    pixels_drawn = 0;
+    double line_time = run_bench_stream(poly_bench_text, poly_bench_size, &line_commands);
+    unsigned long line_pixels = pixels_drawn;
+    bench_snapshot(line_image);
+
+    int same = memcmp(tri_image, line_image, VISIBLE_WIDTH * VISIBLE_HEIGHT * sizeof(uint16_t)) == 0;
+
+    printf("%d triangulos preenchidos\n", POLY_BENCH_SHAPES);
+    printf("%-6s %10s %12s %10s %12s %14s\n", "forma", "comandos", "bytes", "tempo(ms)", "pixels", "pixels/s");
+    printf("%-6s %10ld %12zu %10.2f %12lu %14.0f\n", "TRI", tri_commands, tri_size, tri_time * 1e3, tri_pixels, tri_pixels / tri_time);
+    printf("%-6s %10ld %12zu %10.2f %12lu %14.0f\n", "LINE", line_commands, poly_bench_size, line_time * 1e3, line_pixels, line_pixels / line_time);
+    printf("TRI: %.1fx mais rapido, %.1fx menos bytes no canal; imagens %s\n", line_time / tri_time,
+           (double)poly_bench_size / tri_size, same ? "identicas" : "DIFERENTES");
+
+    free(tri_text);
+    free(poly_bench_text);
+    free(tri_image);
+    free(line_image);
+}
+
+// =================================================================================
+// --- BENCHMARK DO FLOOD (PIOR CASO) ---
+// =================================================================================
+// Mede o FLOOD em regiões que estressam o algoritmo: a tela inteira (poucos
+// trechos longos), labirintos em serpentina de 1 pixel de largura (o máximo
+// de trechos por linha, ou o máximo de linhas encadeadas) e ruído aleatório.
+// Cada cenário é preenchido várias vezes alternando a cor; vale o pior tempo.
+#define FLOOD_BENCH_REPEAT 20
+
+void bench_flood_walls(int scenario) {
+    bench_clear_screen();
+    current_color = WHITE;
+    if (scenario == 1) {
+        // Paredes verticais nas colunas ímpares, com a passagem alternando
+        // entre o topo e o fundo: um corredor de 1 pixel que percorre a tela
+        for (int x = 1; x < VISIBLE_WIDTH; x += 2) {
+            if ((x / 2) % 2 == 0) draw_line(x, 0, x, VISIBLE_HEIGHT - 2);
+            else draw_line(x, 1, x, VISIBLE_HEIGHT - 1);
+        }
+    } else if (scenario == 2) {
+        // O mesmo com paredes horizontais: 120 corredores encadeados
+        for (int y = 1; y < VISIBLE_HEIGHT; y += 2) {
+            if ((y / 2) % 2 == 0) draw_line(0, y, VISIBLE_WIDTH - 2, y);
+            else draw_line(1, y, VISIBLE_WIDTH - 1, y);
+        }
+    } else if (scenario == 3) {
+        srand(1);
+        for (int y = 0; y < VISIBLE_HEIGHT; y++) {
+            for (int x = 0; x < VISIBLE_WIDTH; x++) {
+                if (rand() % 100 < 30) set_pix(x, y);
+            }
+        }
+        current_color = BLACK;
+        draw_tile(0, 0, 7, 7); // Ponto inicial livre e ligado à região principal
+    }
+}
+
+void run_flood_benchmark() {
+    static const char *names[] = { "tela inteira", "labirinto vertical", "labirinto horizontal", "ruido 30%" };
+    quiet = 1;
+    printf("Pilha: %d trechos (%zu KB)\n", FLOOD_STACK_SIZE, sizeof(flood_stack) / 1024);
+    printf("%-22s %10s %12s %12s %14s %10s\n", "regiao", "pixels", "melhor(ms)", "pior(ms)", "pixels/s(pior)", "pilha max");
+    for (int scenario = 0; scenario < 4; scenario++) {
+        bench_flood_walls(scenario);
+        double best = 1e9, worst = 0;
+        int painted = 0, depth = 0;
+        for (int i = 0; i < FLOOD_BENCH_REPEAT; i++) {
+            current_color = (i % 2 == 0) ? RED : BLUE;
+            struct timespec start, end;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            painted = flood_fill(0, 0);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+            if (seconds < best) best = seconds;
+            if (seconds > worst) worst = seconds;
+            if (flood_max_depth > depth) depth = flood_max_depth;
+        }
+        printf("%-22s %10d %12.3f %12.3f %14.0f %10d\n", names[scenario], painted, best * 1e3, worst * 1e3, painted / worst, depth);
+    }
+}
+
+// =================================================================================
+// --- BENCHMARK DO IMG ---
+// =================================================================================
+// Gera um degradê 320x240 em PPM e em BMP num diretório temporário e mede o
+// IMG completo (abrir, mapear, converter, escrever na tela, fechar) com o
+// arquivo já no cache de páginas. Mede também só o núcleo de conversão,
+// vetorizado e escalar, conferindo que os dois dão o mesmo resultado.
+#define IMG_BENCH_REPEAT 50
+
+int write_bench_image(const char *path, int bmp) {
+    FILE *out = fopen(path, "wb");
+    if (out == NULL) return -1;
+    int stride = (VISIBLE_WIDTH * 3 + 3) & ~3;
+    if (bmp) {
+        uint8_t h[54] = { 'B', 'M' };
+        uint32_t fields[][2] = { { 2, 54 + stride * VISIBLE_HEIGHT }, { 10, 54 }, { 14, 40 }, { 18, VISIBLE_WIDTH },
+                                 { 22, VISIBLE_HEIGHT }, { 26, 1 | (24 << 16) }, { 34, stride * VISIBLE_HEIGHT } };
+        for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+            for (int b = 0; b < 4; b++) h[fields[i][0] + b] = (fields[i][1] >> (8 * b)) & 0xFF;
+        }
+        fwrite(h, 1, sizeof(h), out);
+    } else {
+        fprintf(out, "P6\n# degrade\n%d %d\n255\n", VISIBLE_WIDTH, VISIBLE_HEIGHT);
+    }
+    uint8_t row[(VISIBLE_WIDTH * 3 + 3) & ~3];
+    memset(row, 0, sizeof(row));
+    for (int i = 0; i < VISIBLE_HEIGHT; i++) {
+        int y = bmp ? VISIBLE_HEIGHT - 1 - i : i; // BMP: de baixo para cima
+        for (int x = 0; x < VISIBLE_WIDTH; x++) {
+            uint8_t r = x * 255 / (VISIBLE_WIDTH - 1), g = y * 255 / (VISIBLE_HEIGHT - 1), b = (x + y) & 0xFF;
+            row[3 * x + 0] = bmp ? b : r;
+            row[3 * x + 1] = g;
+            row[3 * x + 2] = bmp ? r : b;
+        }
+        fwrite(row, 1, bmp ? stride : VISIBLE_WIDTH * 3, out);
+    }
+    fclose(out);
+    return 0;
+}
+
+void run_image_benchmark() {
+    char dir[] = "/tmp/vga_img_XXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        perror("mkdtemp");
+        return;
+    }
+    char paths[2][64];
+    snprintf(paths[0], sizeof(paths[0]), "%s/degrade.ppm", dir);
+    snprintf(paths[1], sizeof(paths[1]), "%s/degrade.bmp", dir);
+    quiet = 1;
+
+    uint16_t first[2][VISIBLE_WIDTH];
+    printf("IMG 320x240 (nucleo %s), %d repeticoes\n", RGB565_KERNEL, IMG_BENCH_REPEAT);
+    printf("%-8s %12s %12s\n", "formato", "melhor(ms)", "media(ms)");
+    for (int f = 0; f < 2; f++) {
+        if (write_bench_image(paths[f], f) != 0) {
+            perror("Erro ao gerar a imagem");
+            return;
+        }
+        double best = 1e9, total = 0, ms = 0;
+        for (int i = 0; i < IMG_BENCH_REPEAT; i++) {
+            if (draw_image(paths[f], 0, 0, 0, &ms) < 0) return;
+            total += ms;
+            if (ms < best) best = ms;
+        }
+        memcpy(first[f], shadow[0], sizeof(first[f]));
+        printf("%-8s %12.3f %12.3f\n", f ? "BMP" : "PPM", best, total / IMG_BENCH_REPEAT);
+    }
+
+    // Só o núcleo de conversão, com a imagem já mapeada
+    Image img;
+    if (img_open(&img, paths[0]) == 0) {
+        static uint16_t scalar_out[VISIBLE_HEIGHT][VISIBLE_WIDTH];
+        double seconds[2];
+        for (int k = 0; k < 2; k++) {
+            struct timespec start, end;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (int i = 0; i < IMG_BENCH_REPEAT; i++) {
+                for (int y = 0; y < VISIBLE_HEIGHT; y++) {
+                    const uint8_t *src = img.first_row + y * img.row_step;
+                    if (k == 0) rgb565_row(shadow[y], src, VISIBLE_WIDTH, img.bgr);
+                    else rgb565_row_scalar(scalar_out[y], src, VISIBLE_WIDTH, img.bgr);
+                }
+            }
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            seconds[k] = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+        }
+        double pixels = (double)IMG_BENCH_REPEAT * VISIBLE_WIDTH * VISIBLE_HEIGHT;
+        int same = memcmp(shadow, scalar_out, sizeof(scalar_out)) == 0 &&
+                   memcmp(first[0], first[1], sizeof(first[0])) == 0;
+        printf("Conversao: %s %.0f Mpixels/s, escalar %.0f Mpixels/s (%.1fx); resultados %s\n", RGB565_KERNEL,
+               pixels / seconds[0] / 1e6, pixels / seconds[1] / 1e6, seconds[1] / seconds[0], same ? "identicos" : "DIFERENTES");
+        img_close(&img);
+    }
+    unlink(paths[0]);
+    unlink(paths[1]);
+    rmdir(dir);
+}
+
+// =================================================================================
+// --- BENCHMARK DO PONTILHADO ORDENADO ---
+// =================================================================================
+// Mede a conversão RGB888 -> RGB565 truncando e com pontilhado (vetorizada e
+// escalar, que devem dar o mesmo resultado) e compara a qualidade das duas num
+// degradê suave, onde a truncagem mostra faixas: erro médio por canal (viés),
+// PSNR pixel a pixel e PSNR depois de uma média em blocos 4x4, que é mais ou
+// menos o que o olho vê de longe.
+#define DITHER_BENCH_REPEAT 200
+
+// Canal de 5 ou 6 bits de volta para 8 bits, repetindo os bits de cima
+void expand_rgb565(uint16_t px, int out[3]) {
+    int r = px >> 11, g = (px >> 5) & 0x3F, b = px & 0x1F;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+}
+
+double psnr(double squared_error, long samples) {
+    if (squared_error == 0) return INFINITY;
+    return 10 * log10(255.0 * 255.0 * samples / squared_error);
+}
+
+// Erro médio por canal, PSNR por pixel e PSNR das médias 4x4
+void dither_quality(const uint8_t *rgb, uint16_t (*out)[VISIBLE_WIDTH], double bias[3], double *pixel_psnr, double *block_psnr) {
+    double sum[3] = { 0, 0, 0 }, squared = 0, block_squared = 0;
+    for (int by = 0; by < VISIBLE_HEIGHT; by += 4) {
+        for (int bx = 0; bx < VISIBLE_WIDTH; bx += 4) {
+            int original[3] = { 0, 0, 0 }, converted[3] = { 0, 0, 0 };
+            for (int y = by; y < by + 4; y++) {
+                for (int x = bx; x < bx + 4; x++) {
+                    int c[3];
+                    expand_rgb565(out[y][x], c);
+                    for (int k = 0; k < 3; k++) {
+                        int e = c[k] - rgb[(y * VISIBLE_WIDTH + x) * 3 + k];
+                        sum[k] += e;
+                        squared += e * e;
+                        original[k] += rgb[(y * VISIBLE_WIDTH + x) * 3 + k];
+                        converted[k] += c[k];
+                    }
+                }
+            }
+            for (int k = 0; k < 3; k++) {
+                double e = (converted[k] - original[k]) / 16.0;
+                block_squared += e * e;
+            }
+        }
+    }
+    long pixels = (long)VISIBLE_WIDTH * VISIBLE_HEIGHT;
+    for (int k = 0; k < 3; k++) bias[k] = sum[k] / pixels;
+    *pixel_psnr = psnr(squared, pixels * 3);
+    *block_psnr = psnr(block_squared, pixels / 16 * 3);
+}
+
+void run_dither_benchmark() {
+    static uint8_t rgb[VISIBLE_HEIGHT * VISIBLE_WIDTH * 3];
+    static uint16_t out[3][VISIBLE_HEIGHT][VISIBLE_WIDTH];
+    static const char *names[] = { "truncar", "pontilhado", "pontilhado escalar" };
+
+    // Degradê lento (poucos degraus de 565 na tela toda): o pior caso das faixas
+    for (int y = 0; y < VISIBLE_HEIGHT; y++) {
+        for (int x = 0; x < VISIBLE_WIDTH; x++) {
+            uint8_t *p = &rgb[(y * VISIBLE_WIDTH + x) * 3];
+            p[0] = 40 + x * 48 / VISIBLE_WIDTH;
+            p[1] = 90 + y * 40 / VISIBLE_HEIGHT;
+            p[2] = 160 - (x + y) * 32 / (VISIBLE_WIDTH + VISIBLE_HEIGHT);
+        }
+    }
+
+    double seconds[3];
+    for (int k = 0; k < 3; k++) {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < DITHER_BENCH_REPEAT; i++) {
+            for (int y = 0; y < VISIBLE_HEIGHT; y++) {
+                const uint8_t *src = &rgb[y * VISIBLE_WIDTH * 3];
+                if (k == 0) rgb565_row(out[0][y], src, VISIBLE_WIDTH, 0);
+                else if (k == 1) rgb565_dither_row(out[1][y], src, VISIBLE_WIDTH, 0, 0, y);
+                else rgb565_dither_row_scalar(out[2][y], src, VISIBLE_WIDTH, 0, 0, y);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        seconds[k] = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    }
+
+    double pixels = (double)DITHER_BENCH_REPEAT * VISIBLE_WIDTH * VISIBLE_HEIGHT;
+    printf("RGB888 -> RGB565 320x240 (nucleo %s), %d repeticoes\n", RGB565_KERNEL, DITHER_BENCH_REPEAT);
+    printf("%-20s %12s %12s\n", "conversao", "Mpixels/s", "ms/quadro");
+    for (int k = 0; k < 3; k++) {
+        printf("%-20s %12.0f %12.3f\n", names[k], pixels / seconds[k] / 1e6, seconds[k] / DITHER_BENCH_REPEAT * 1e3);
+    }
+    printf("Pontilhado %s x escalar: %.1fx, resultados %s\n\n", RGB565_KERNEL, seconds[2] / seconds[1],
+           memcmp(out[1], out[2], sizeof(out[1])) == 0 ? "identicos" : "DIFERENTES");
+
+    printf("Qualidade no degrade (565 expandido para 888):\n");
+    printf("%-12s %24s %12s %14s\n", "conversao", "erro medio R/G/B", "PSNR(dB)", "PSNR 4x4(dB)");
+    for (int k = 0; k < 2; k++) {
+        double bias[3], pixel_psnr, block_psnr;
+        dither_quality(rgb, out[k], bias, &pixel_psnr, &block_psnr);
+        printf("%-12s %8.2f/%6.2f/%6.2f %12.2f %14.2f\n", names[k], bias[0], bias[1], bias[2], pixel_psnr, block_psnr);
+    }
+}
+
+// =================================================================================
+// --- SERVIDOR DE DESENHO (SOCKET UNIX + EPOLL) ---
+// =================================================================================
+// Vários clientes conectam no socket e enviam comandos de texto ou quadros
+// binários. Cada cliente tem seu próprio interpretador (BatchState), então um
+// comando pela metade não bloqueia os outros; os comandos são aplicados na
+// ordem em que chegam. A cada segundo a taxa de comandos e a fila (bytes
+// recebidos e ainda não executados) de cada cliente são gravadas em
+// <socket>.stats.
+#define SERVER_MAX_CLIENTS  128
+#define SERVER_READ_CHUNK   4096  // Máximo lido de um cliente por vez (justiça entre clientes)
+#define SERVER_MAX_EVENTS   64
+
+typedef struct {
+    int fd;
+    BatchState parser;
+    long last_commands;         // Comandos no último relatório
+    double rate;                // Comandos/s no último intervalo
+} Client;
+
+volatile sig_atomic_t server_stop = 0;
+
+void handle_server_signal(int sig) {
+    (void)sig;
+    server_stop = 1;
+}
+
+// Fila do cliente: bytes ainda no socket mais o comando parcial já lido
+int client_queue_depth(const Client *client) {
+    int pending = 0;
+    if (ioctl(client->fd, FIONREAD, &pending) != 0) pending = 0;
+    return pending + client->parser.len + client->parser.binary.len;
+}
+
+void write_server_stats(const char *stats_path, Client *clients[], double interval) {
+    char tmp_path[256];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", stats_path);
+    FILE *out = fopen(tmp_path, "w");
+    if (out == NULL) return;
+    fprintf(out, "%6s %12s %10s %12s %10s\n", "fd", "comandos", "invalidos", "comandos/s", "fila");
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        Client *c = clients[i];
+        if (c == NULL) continue;
+        c->rate = (c->parser.commands - c->last_commands) / interval;
+        c->last_commands = c->parser.commands;
+        fprintf(out, "%6d %12ld %10ld %12.0f %10d\n", c->fd, c->parser.commands, c->parser.errors,
+                c->rate, client_queue_depth(c));
+    }
+    fclose(out);
+    rename(tmp_path, stats_path); // Troca atômica para quem estiver lendo
+}
+
+void close_client(int epoll_fd, Client *clients[], Client *client) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        if (clients[i] == client) clients[i] = NULL;
+    }
+    free(client);
+}
+
+int run_server(const char *socket_path) {
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (listen_fd == -1) {
+        perror("Erro ao criar o socket");
+        return 1;
+    }
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+    unlink(socket_path);
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_fd, SERVER_MAX_CLIENTS) != 0) {
+        perror("Erro ao escutar no socket");
+        close(listen_fd);
+        return 1;
+    }
+
+    int epoll_fd = epoll_create1(0);
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = NULL }; // NULL = socket de escuta
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+
+    char stats_path[256];
+    snprintf(stats_path, sizeof(stats_path), "%s.stats", socket_path);
+    signal(SIGINT, handle_server_signal);
+    signal(SIGTERM, handle_server_signal);
+    quiet = 1;
+
+    printf("Servidor de desenho em %s (estatisticas em %s). CTRL+C para sair.\n", socket_path, stats_path);
+    fflush(stdout);
+
+    Client *clients[SERVER_MAX_CLIENTS] = { NULL };
+    static char block[SERVER_READ_CHUNK];
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    struct timespec last_report, now;
+    clock_gettime(CLOCK_MONOTONIC, &last_report);
+
+    while (!server_stop) {
+        int count = epoll_wait(epoll_fd, events, SERVER_MAX_EVENTS, 1000);
+        for (int i = 0; i < count; i++) {
+            Client *client = (Client *)events[i].data.ptr;
+            if (client == NULL) {
+                // Novas conexões
+                int fd;
+                while ((fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK)) != -1) {
+                    int slot = 0;
+                    while (slot < SERVER_MAX_CLIENTS && clients[slot] != NULL) slot++;
+                    if (slot == SERVER_MAX_CLIENTS) { close(fd); continue; }
+                    client = calloc(1, sizeof(Client));
+                    if (client == NULL) {
+                        perror("Erro ao alocar cliente");
+                        close(fd);
+                        continue;
+                    }
+                    client->fd = fd;
+                    // Só entra na tabela se o epoll acompanha o fd (senão nunca seria removido)
+                    struct epoll_event client_ev = { .events = EPOLLIN | EPOLLRDHUP, .data.ptr = client };
+                    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &client_ev) != 0) {
+                        perror("Erro ao registrar cliente no epoll");
+                        free(client);
+                        close(fd);
+                        continue;
+                    }
+                    clients[slot] = client;
+                }
+                continue;
+            }
+
+            // Lê um bloco limitado; o restante fica para a próxima volta (epoll por nível)
+            ssize_t n = read(client->fd, block, sizeof(block));
+            if (n > 0) {
+                batch_feed(&client->parser, block, n);
+                if (client->parser.finished) close_client(epoll_fd, clients, client);
+            } else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+                close_client(epoll_fd, clients, client);
+            }
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double interval = (now.tv_sec - last_report.tv_sec) + (now.tv_nsec - last_report.tv_nsec) / 1e9;
+        if (interval >= 1.0) {
+            write_server_stats(stats_path, clients, interval);
+            last_report = now;
+        }
+    }
+
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        if (clients[i] != NULL) close_client(epoll_fd, clients, clients[i]);
+    }
+    close(epoll_fd);
+    close(listen_fd);
+    unlink(socket_path);
+    return 0;
+}
+
+// =================================================================================
+// --- GERADOR DE CARGA PARA O SERVIDOR ---
+// =================================================================================
+// Abre 1, 2, 4, ... 64 conexões e envia quadros binários LINE (10 bytes cada)
+// o mais rápido possível, medindo a vazão sustentada de cada configuração.
+// Os bytes que ainda estão no buffer do socket ao fim da medida (SIOCOUTQ)
+// não contam: só vale o que o servidor já leu e executou.
+#define LOAD_MAX_CLIENTS    64
+#define LOAD_FRAMES         1024
+
+int run_load_generator(const char *socket_path, int seconds) {
+    signal(SIGPIPE, SIG_IGN);
+
+    // Sequência cíclica de quadros de tamanho fixo
+    static uint8_t stream[LOAD_FRAMES * PROTO_MAX_FRAME];
+    int frame_size = 0;
+    srand(1);
+    for (int i = 0; i < LOAD_FRAMES; i++) {
+        DrawCommand cmd = { PROTO_LINE, { rand() % VISIBLE_WIDTH, rand() % VISIBLE_HEIGHT,
+                                          rand() % VISIBLE_WIDTH, rand() % VISIBLE_HEIGHT } };
+        frame_size = proto_encode(&cmd, stream + i * frame_size);
+    }
+    size_t stream_size = (size_t)LOAD_FRAMES * frame_size;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+
+    printf("%8s %14s %18s\n", "clientes", "comandos/s", "por cliente");
+    for (int clients = 1; clients <= LOAD_MAX_CLIENTS; clients *= 2) {
+        struct pollfd fds[LOAD_MAX_CLIENTS];
+        size_t offset[LOAD_MAX_CLIENTS];
+        unsigned long long sent = 0;
+
+        for (int i = 0; i < clients; i++) {
+            fds[i].fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            fds[i].events = POLLOUT;
+            offset[i] = 0;
+            if (fds[i].fd == -1 || connect(fds[i].fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+                perror("Erro ao conectar no servidor");
+                return 1;
+            }
+            fcntl(fds[i].fd, F_SETFL, O_NONBLOCK);
+        }
+
+        struct timespec start, now;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        double elapsed = 0;
+        while (elapsed < seconds) {
+            if (poll(fds, clients, 100) > 0) {
+                for (int i = 0; i < clients; i++) {
+                    if (!(fds[i].revents & POLLOUT)) continue;
+                    ssize_t n = write(fds[i].fd, stream + offset[i], stream_size - offset[i]);
+                    if (n > 0) {
+                        sent += n;
+                        offset[i] = (offset[i] + n) % stream_size;
+                    }
+                }
+            }
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            elapsed = (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+        }
+        for (int i = 0; i < clients; i++) {
+            int unread = 0;
+            if (ioctl(fds[i].fd, SIOCOUTQ, &unread) == 0) sent -= unread;
+            close(fds[i].fd);
+        }
+
+        double rate = (sent / frame_size) / elapsed;
+        printf("%8d %14.0f %18.0f\n", clients, rate, rate / clients);
+        fflush(stdout);
+        usleep(200000); // Deixa o servidor esvaziar as filas antes da próxima rodada
+    }
+    return 0;
+}
+
+// Usa um framebuffer em memória quando não há /dev/mem (benchmarks e testes)
+void use_offscreen_framebuffer() {
+    static uint16_t offscreen[VISIBLE_HEIGHT][LWIDTH];
+    tela = offscreen;
+    sync_shadow();
+    printf("Usando framebuffer em memoria.\n");
+}
+
+int main(int argc, char *argv[]) {
+    // Uso: ./vga --bench-protocol (desenha em memória se não houver /dev/mem)
+    if (argc > 1 && strcmp(argv[1], "--bench-protocol") == 0) {
+        if (init_vga() != 0) use_offscreen_framebuffer();
+        run_protocol_benchmark();
+        return 0;
+    }
+
+    // Uso: ./vga --bench-poly (preenchimento TRI x LINE equivalentes)
+    if (argc > 1 && strcmp(argv[1], "--bench-poly") == 0) {
+        if (init_vga() != 0) use_offscreen_framebuffer();
+        run_poly_benchmark();
+        return 0;
+    }
+
+    // Uso: ./vga --bench-flood (pior caso do FLOOD)
+    if (argc > 1 && strcmp(argv[1], "--bench-flood") == 0) {
+        if (init_vga() != 0) use_offscreen_framebuffer();
+        run_flood_benchmark();
+        return 0;
+    }
+
+    // Uso: ./vga --bench-img (tempo do IMG de uma imagem 320x240)
+    if (argc > 1 && strcmp(argv[1], "--bench-img") == 0) {
+        if (init_vga() != 0) use_offscreen_framebuffer();
+        run_image_benchmark();
+        return 0;
+    }
+
+    // Uso: ./vga --bench-dither (truncar x pontilhado: velocidade e qualidade)
+    if (argc > 1 && strcmp(argv[1], "--bench-dither") == 0) {
+        run_dither_benchmark();
+        return 0;
+    }
+
+    // Uso: ./vga --load <socket> [segundos]  (gerador de carga, não usa a VGA)
+    if (argc > 2 && strcmp(argv[1], "--load") == 0) {
+        return run_load_generator(argv[2], argc > 3 ? atoi(argv[3]) : 3);
+    }
+
+    // Uso: ./vga --server <socket>
+    if (argc > 2 && strcmp(argv[1], "--server") == 0) {
+        if (init_vga() != 0) use_offscreen_framebuffer();
+        return run_server(argv[2]);
+    }
+
     if (init_vga() != 0) {
         return 1;
     }
 
-    char command[100], params[100];
-    char input[200];
+    // Uso: ./vga --batch <arquivo>   (ou "-" para ler da entrada padrão/pipe)
+    if (argc > 2 && strcmp(argv[1], "--batch") == 0) {
+        return run_batch(argv[2]);
+    }
+
+    char input[MAX_LINE];
 
     printf("Sistema de desenho VGA - DE1-SoC (Linux on ARMv7)\n");
     printf("Tela VGA inicializada com sucesso.\n");
@@ -249,50 +1563,31 @@ int main() {
     // Executa a sequência de demonstração automática
     run_demo_sequence();
 
+    int show_menu = 1;
     while (1) {
-        print_menu();
-        printf("> ");
-        fflush(stdout);
+        // O menu só é reexibido após comandos de texto
+        if (show_menu) {
+            print_menu();
+            printf("> ");
+            fflush(stdout);
+            show_menu = 0;
+        }
+
+        // Um quadro binário é reconhecido pelo primeiro byte
+        int first = getchar();
+        if (first == EOF) break;
+        if (first == PROTO_MAGIC) {
+            if (read_binary_command() < 0) break;
+            continue;
+        }
+        ungetc(first, stdin);
 
         read_line(input, sizeof(input));
-        to_upper(input);
-        
-        // Limpa os buffers antes de parsear
-        command[0] = '\0';
-        params[0] = '\0';
-        sscanf(input, "%s %[^\n]", command, params);
-        
-        if (strcmp(command, "1") == 0 || strcmp(command, "COLOR") == 0) {
-            set_color(params);
-        } else if (strcmp(command, "2") == 0 || strcmp(command, "LINE") == 0) {
-            int x0, y0, x1, y1;
-            if (sscanf(params, "%d %d %d %d", &x0, &y0, &x1, &y1) == 4) {
-                draw_line(x0, y0, x1, y1);
-            } else { printf("Formato invalido. Use: LINE x0 y0 x1 y1\n"); }
-        } else if (strcmp(command, "3") == 0 || strcmp(command, "CIRC") == 0) {
-            int xc, yc, r;
-            if (sscanf(params, "%d %d %d", &xc, &yc, &r) == 3) {
-                draw_circle(xc, yc, r);
-            } else { printf("Formato invalido. Use: CIRC xc yc r\n"); }
-        } else if (strcmp(command, "4") == 0 || strcmp(command, "RECT") == 0) {
-            int x0, y0, x1, y1;
-            if (sscanf(params, "%d %d %d %d", &x0, &y0, &x1, &y1) == 4) {
-                draw_rect(x0, y0, x1, y1);
-            } else { printf("Formato invalido. Use: RECT x0 y0 x1 y1\n"); }
-        } else if (strcmp(command, "5") == 0 || strcmp(command, "TILE") == 0) {
-            int x0, y0, x1, y1;
-            if (sscanf(params, "%d %d %d %d", &x0, &y0, &x1, &y1) == 4) {
-                draw_tile(x0, y0, x1, y1);
-            } else { printf("Formato invalido. Use: TILE x0 y0 x1 y1\n"); }
-        } else if (strcmp(command, "6") == 0 || strcmp(command, "FUNDO") == 0) {
-            fill_screen();
-            printf("Tela preenchida com a cor atual.\n");
-        } else if (strcmp(command, "7") == 0 || strcmp(command, "SAIR") == 0) {
+        if (execute_command(input) < 0) {
             break;
-        } else if (strlen(command) > 0) { // Evita msg de erro para entrada vazia
-            printf("Comando desconhecido: %s\n", command);
         }
+        show_menu = 1;
     }
 
     return 0;
-}
\ No newline at end of file
+}